@@ -0,0 +1 @@
+../../x86/util/memory.cxx
\ No newline at end of file
@@ -1,13 +1,18 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 19 of 2021, at 09:53 BRT
- * Last edited on July 21 of 2021 at 15:43 BRT */
+ * Last edited on October 20 of 2026 at 09:40 BRT */
 
 #pragma once
 
 #define ARCH_PAUSE() asm volatile("pause" ::: "memory")
 #define ARCH_SENSITIVE_END() if (Context & 0x200) asm volatile("sti")
 
+/* The FPU (and the vector registers) can be used without trapping as long as CR0.TS is clear (the kernel sets it when
+ * the registers don't have the state of whoever is running right now). */
+
+#define ARCH_FPU_USABLE() ({ UIntPtr cr0; asm volatile("mov %%cr0, %0" : "=r"(cr0)); !(cr0 & 0x08); })
+
 #ifdef __i386__
 #define ARCH_SENSITIVE_START() asm volatile("pushfl; pop %0; cli" : "=r"(Context) :: "cc")
 #else
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 18 of 2021, at 13:17 BRT
- * Last edited on July 20 of 2021 at 15:20 BRT */
+ * Last edited on October 19 of 2026 at 23:55 BRT */
 
 disable_ubsan static inline always_inline Floatx2 Round(Floatx2 Vector) { return __builtin_ia32_roundpd(Vector, 0); }
 #ifndef NO_256_SIMD
@@ -32,3 +32,10 @@ disable_ubsan static inline always_inline Void StoreNonTemporal(Void *Buffer, Fl
     __builtin_ia32_movntpd256(static_cast<Float*>(Buffer), Value);
 }
 #endif
+
+/* One bit per byte (the top bit of each of them), used to turn a byte compare into a mask that we can scan with
+ * BitOp::ScanForward (the hash table probing uses this for the control bytes). */
+
+disable_ubsan static inline always_inline UInt32 MoveMask(Charx16 Vector) {
+    return __builtin_ia32_pmovmskb128(Vector);
+}
@@ -0,0 +1,785 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 18:40 BRT
+ * Last edited on October 20 of 2026, at 11:10 BRT */
+
+#include <base/simd.hxx>
+#include <util/memory.hxx>
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#define TARGET_GPR __attribute__((target("general-regs-only")))
+
+namespace CHicago {
+
+typedef UInt32 UInt32U aligned(1);
+typedef UInt64 UInt64U aligned(1);
+
+/* Disable UBSan for the memory functions (so that the compiler will not generate a check every single store). The
+ * templates are always inlined into the per-target functions below, so the compiler generates one copy of them for
+ * each SIMD level (using the right instructions for it). V is the vector type, and VU its unaligned version (declared
+ * inside each template, as passing it as a template argument silently drops the alignment attribute). */
+
+template<class V> static disable_ubsan inline always_inline
+Void CopySmall(UInt8 *Buffer, const UInt8 *Source, UIntPtr Length) {
+    /* Anything smaller than a vector: two (possibly overlapping) loads/stores of the biggest size that fits. */
+
+    if constexpr (sizeof(V) > 32) {
+        if (Length >= 32) {
+            UInt8x32 a = *reinterpret_cast<const UInt8x32U*>(Source),
+                     b = *reinterpret_cast<const UInt8x32U*>(Source + Length - 32);
+            *reinterpret_cast<UInt8x32U*>(Buffer) = a, *reinterpret_cast<UInt8x32U*>(Buffer + Length - 32) = b;
+            return;
+        }
+    }
+
+    if constexpr (sizeof(V) > 16) {
+        if (Length >= 16) {
+            UInt8x16 a = *reinterpret_cast<const UInt8x16U*>(Source),
+                     b = *reinterpret_cast<const UInt8x16U*>(Source + Length - 16);
+            *reinterpret_cast<UInt8x16U*>(Buffer) = a, *reinterpret_cast<UInt8x16U*>(Buffer + Length - 16) = b;
+            return;
+        }
+    }
+
+    if (Length >= 8) {
+        UInt64 a = *reinterpret_cast<const UInt64U*>(Source),
+               b = *reinterpret_cast<const UInt64U*>(Source + Length - 8);
+        *reinterpret_cast<UInt64U*>(Buffer) = a, *reinterpret_cast<UInt64U*>(Buffer + Length - 8) = b;
+    } else if (Length >= 4) {
+        UInt32 a = *reinterpret_cast<const UInt32U*>(Source),
+               b = *reinterpret_cast<const UInt32U*>(Source + Length - 4);
+        *reinterpret_cast<UInt32U*>(Buffer) = a, *reinterpret_cast<UInt32U*>(Buffer + Length - 4) = b;
+    } else if (Length) {
+        UInt8 a = Source[0], b = Source[Length >> 1], c = Source[Length - 1];
+        Buffer[0] = a, Buffer[Length >> 1] = b, Buffer[Length - 1] = c;
+    }
+}
+
+/* Mask of the bytes that differ between two vectors (bit N set = byte N differs). The AVX2/AVX-512 versions can't be
+ * always_inline (MismatchLoop itself gets compiled before being inlined into the per-target functions, and GCC refuses
+ * to force target-specific code into it), but they still get inlined where they are used. */
+
+static disable_ubsan inline always_inline UInt64 GetDiffMask(UInt8x16 Left, UInt8x16 Right) {
+    return ~__builtin_ia32_pmovmskb128(__builtin_bit_cast(Charx16, Left == Right)) & 0xFFFF;
+}
+
+static TARGET_AVX2 disable_ubsan inline UInt64 GetDiffMask(UInt8x32 Left, UInt8x32 Right) {
+    return ~static_cast<UInt32>(__builtin_ia32_pmovmskb256(__builtin_bit_cast(Charx32, Left == Right)));
+}
+
+static TARGET_AVX512 disable_ubsan inline UInt64 GetDiffMask(UInt8x64 Left, UInt8x64 Right) {
+    return __builtin_ia32_cmpb512_mask(__builtin_bit_cast(Charx64, Left), __builtin_bit_cast(Charx64, Right), 4, ~0ull);
+}
+
+/* Non-temporal (aligned) stores, one for each vector size. Just like GetDiffMask, the AVX2/AVX-512 versions can't be
+ * always_inline. */
+
+static disable_ubsan inline always_inline Void StoreNonTemporal(UInt8 *Buffer, UInt8x16 Value) {
+    SIMD::StoreNonTemporal(Buffer, __builtin_bit_cast(Int64x2, Value));
+}
+
+static TARGET_AVX2 disable_ubsan inline Void StoreNonTemporal(UInt8 *Buffer, UInt8x32 Value) {
+    __builtin_ia32_movntdq256(reinterpret_cast<Int64x4*>(Buffer), __builtin_bit_cast(Int64x4, Value));
+}
+
+static TARGET_AVX512 disable_ubsan inline Void StoreNonTemporal(UInt8 *Buffer, UInt8x64 Value) {
+    __builtin_ia32_movntdq512(reinterpret_cast<Int64x8*>(Buffer), __builtin_bit_cast(Int64x8, Value));
+}
+
+template<class V, Boolean NonTemporal> static disable_ubsan inline always_inline
+Void StoreBody(UInt8 *Buffer, const V &Value) {
+    /* Aligned store of the main loops: the non-temporal version skips the caches (for buffers much bigger than them,
+     * where the data would just evict everything else and be evicted itself before anyone reads it). */
+
+    if constexpr (NonTemporal) StoreNonTemporal(Buffer, Value);
+    else *reinterpret_cast<V*>(Buffer) = Value;
+}
+
+template<class V, Boolean NonTemporal = False> static disable_ubsan inline always_inline
+Void CopyLoop(UInt8 *Buffer, const UInt8 *Source, UIntPtr Length) {
+    /* The first and the last vectors are unaligned stores (the last one ending right at the end of the buffer), and
+     * everything in between uses aligned stores (overlapping with the first/last ones where required). Loads are
+     * always unaligned, as we can only align one side. */
+
+    typedef V VU aligned(1);
+
+    if (Length < sizeof(V)) {
+        CopySmall<V>(Buffer, Source, Length);
+        return;
+    }
+
+    UIntPtr skip = -reinterpret_cast<UIntPtr>(Buffer) & (sizeof(V) - 1);
+    UInt8 *dst = Buffer + skip;
+    const UInt8 *src = Source + skip;
+
+    *reinterpret_cast<VU*>(Buffer) = *reinterpret_cast<const VU*>(Source);
+    Length -= skip;
+
+    while (Length >= sizeof(V) * 4) {
+        V a = *reinterpret_cast<const VU*>(src), b = *reinterpret_cast<const VU*>(src + sizeof(V)),
+          c = *reinterpret_cast<const VU*>(src + sizeof(V) * 2), d = *reinterpret_cast<const VU*>(src + sizeof(V) * 3);
+        StoreBody<V, NonTemporal>(dst, a), StoreBody<V, NonTemporal>(dst + sizeof(V), b);
+        StoreBody<V, NonTemporal>(dst + sizeof(V) * 2, c), StoreBody<V, NonTemporal>(dst + sizeof(V) * 3, d);
+        Length -= sizeof(V) * 4;
+        dst += sizeof(V) * 4;
+        src += sizeof(V) * 4;
+    }
+
+    while (Length >= sizeof(V)) {
+        V a = *reinterpret_cast<const VU*>(src);
+        StoreBody<V, NonTemporal>(dst, a);
+        Length -= sizeof(V);
+        dst += sizeof(V);
+        src += sizeof(V);
+    }
+
+    if (Length) {
+        *reinterpret_cast<VU*>(dst + Length - sizeof(V)) = *reinterpret_cast<const VU*>(src + Length - sizeof(V));
+    }
+
+    /* Non-temporal stores are weakly ordered, so make sure they are visible before anything that comes after us. */
+
+    if constexpr (NonTemporal) asm volatile("sfence" ::: "memory");
+}
+
+template<class V> static disable_ubsan inline always_inline
+Void MoveLoop(UInt8 *Buffer, const UInt8 *Source, UIntPtr Length) {
+    /* Same idea as CopyLoop, but the regions may overlap: if the destination comes first, we go forward, else, we go
+     * backwards (starting at the aligned end of the destination). Either way, every load in the loop reads bytes that
+     * no earlier store touched, and the first/last vectors (and CopySmall) are loaded before storing anything, so the
+     * unaligned head/tail stores are only done at the very end. */
+
+    typedef V VU aligned(1);
+    constexpr UIntPtr N = sizeof(V);
+
+    if (Length < N) {
+        CopySmall<V>(Buffer, Source, Length);
+        return;
+    }
+
+    V head = *reinterpret_cast<const VU*>(Source), tail = *reinterpret_cast<const VU*>(Source + Length - N);
+
+    if (Buffer < Source) {
+        UIntPtr off = -reinterpret_cast<UIntPtr>(Buffer) & (N - 1);
+
+        for (; off + N * 4 <= Length; off += N * 4) {
+            V a = *reinterpret_cast<const VU*>(Source + off), b = *reinterpret_cast<const VU*>(Source + off + N),
+              c = *reinterpret_cast<const VU*>(Source + off + N * 2),
+              d = *reinterpret_cast<const VU*>(Source + off + N * 3);
+            *reinterpret_cast<V*>(Buffer + off) = a, *reinterpret_cast<V*>(Buffer + off + N) = b;
+            *reinterpret_cast<V*>(Buffer + off + N * 2) = c, *reinterpret_cast<V*>(Buffer + off + N * 3) = d;
+        }
+
+        for (; off + N <= Length; off += N)
+            *reinterpret_cast<V*>(Buffer + off) = *reinterpret_cast<const VU*>(Source + off);
+    } else {
+        UIntPtr off = Length - (reinterpret_cast<UIntPtr>(Buffer + Length) & (N - 1));
+
+        for (; off >= N * 4; off -= N * 4) {
+            V a = *reinterpret_cast<const VU*>(Source + off - N),
+              b = *reinterpret_cast<const VU*>(Source + off - N * 2),
+              c = *reinterpret_cast<const VU*>(Source + off - N * 3),
+              d = *reinterpret_cast<const VU*>(Source + off - N * 4);
+            *reinterpret_cast<V*>(Buffer + off - N) = a, *reinterpret_cast<V*>(Buffer + off - N * 2) = b;
+            *reinterpret_cast<V*>(Buffer + off - N * 3) = c, *reinterpret_cast<V*>(Buffer + off - N * 4) = d;
+        }
+
+        for (; off >= N; off -= N)
+            *reinterpret_cast<V*>(Buffer + off - N) = *reinterpret_cast<const VU*>(Source + off - N);
+    }
+
+    *reinterpret_cast<VU*>(Buffer) = head;
+    *reinterpret_cast<VU*>(Buffer + Length - N) = tail;
+}
+
+template<class V, Boolean NonTemporal = False> static disable_ubsan inline always_inline
+Void FillLoop(UInt8 *Buffer, const V &Pattern, UInt64 Small, UIntPtr Period, UIntPtr Length) {
+    /* Shared by SetMemory (Period = 1) and SetMemory32 (Period = 4): same idea as CopyLoop, but we can only align the
+     * destination if that doesn't break the pattern (and every overlapping store needs to be at a multiple of the
+     * period from the start). Small has the pattern repeated over 8 bytes. */
+
+    typedef V VU aligned(1);
+
+    if (Length < sizeof(V)) {
+        if (Length >= 8) {
+            for (UIntPtr i = 0; i + 8 < Length; i += 8) *reinterpret_cast<UInt64U*>(Buffer + i) = Small;
+            *reinterpret_cast<UInt64U*>(Buffer + Length - 8) = Small;
+        } else if (Length >= 4) {
+            *reinterpret_cast<UInt32U*>(Buffer) = Small;
+            *reinterpret_cast<UInt32U*>(Buffer + Length - 4) = Small;
+        } else if (Length) Buffer[0] = Buffer[Length >> 1] = Buffer[Length - 1] = Small;
+
+        return;
+    }
+
+    UIntPtr skip = -reinterpret_cast<UIntPtr>(Buffer) & (sizeof(V) - 1);
+    UInt8 *dst = Buffer + (skip % Period ? 0 : skip);
+
+    *reinterpret_cast<VU*>(Buffer) = Pattern;
+    Length -= dst - Buffer;
+
+    /* Non-temporal stores need to be aligned (which is always the case unless this is SetMemory32 with a destination
+     * that isn't 4-byte aligned). */
+
+    if (NonTemporal && !(reinterpret_cast<UIntPtr>(dst) & (sizeof(V) - 1))) {
+        while (Length >= sizeof(V) * 4) {
+            StoreBody<V, NonTemporal>(dst, Pattern), StoreBody<V, NonTemporal>(dst + sizeof(V), Pattern);
+            StoreBody<V, NonTemporal>(dst + sizeof(V) * 2, Pattern);
+            StoreBody<V, NonTemporal>(dst + sizeof(V) * 3, Pattern);
+            Length -= sizeof(V) * 4;
+            dst += sizeof(V) * 4;
+        }
+    }
+
+    while (Length >= sizeof(V) * 4) {
+        *reinterpret_cast<VU*>(dst) = Pattern, *reinterpret_cast<VU*>(dst + sizeof(V)) = Pattern;
+        *reinterpret_cast<VU*>(dst + sizeof(V) * 2) = Pattern, *reinterpret_cast<VU*>(dst + sizeof(V) * 3) = Pattern;
+        Length -= sizeof(V) * 4;
+        dst += sizeof(V) * 4;
+    }
+
+    while (Length >= sizeof(V)) {
+        *reinterpret_cast<VU*>(dst) = Pattern;
+        Length -= sizeof(V);
+        dst += sizeof(V);
+    }
+
+    if (Length) *reinterpret_cast<VU*>(dst + Length - sizeof(V)) = Pattern;
+    if constexpr (NonTemporal) asm volatile("sfence" ::: "memory");
+}
+
+template<class V> static disable_ubsan inline always_inline
+UIntPtr MismatchLoop(const UInt8 *Left, const UInt8 *Right, UIntPtr Length) {
+    /* Returns the offset of the first byte that differs (or Length if there is none). Two vectors per iteration (or
+     * one if we don't have that much left), and the last vector overlaps with what we already compared (which is fine,
+     * as we know those bytes are equal). Anything smaller than a vector goes through the smaller sizes. */
+
+    typedef V VU aligned(1);
+    constexpr UIntPtr N = sizeof(V);
+
+    if constexpr (N > 16) {
+        if (Length < N) return MismatchLoop<UInt8x16>(Left, Right, Length);
+    } else if (Length < N) {
+        if (Length >= 8) {
+            UInt64 a = *reinterpret_cast<const UInt64U*>(Left) ^ *reinterpret_cast<const UInt64U*>(Right),
+                   b = *reinterpret_cast<const UInt64U*>(Left + Length - 8) ^
+                       *reinterpret_cast<const UInt64U*>(Right + Length - 8);
+            return a ? __builtin_ctzll(a) >> 3 : (b ? Length - 8 + (__builtin_ctzll(b) >> 3) : Length);
+        }
+
+        for (UIntPtr i = 0; i < Length; i++) if (Left[i] != Right[i]) return i;
+        return Length;
+    }
+
+    UIntPtr off = 0;
+    UInt64 mask;
+
+    for (; off + N * 2 <= Length; off += N * 2) {
+        V a = *reinterpret_cast<const VU*>(Left + off), b = *reinterpret_cast<const VU*>(Right + off),
+          c = *reinterpret_cast<const VU*>(Left + off + N), d = *reinterpret_cast<const VU*>(Right + off + N);
+        if ((mask = GetDiffMask(a, b))) return off + __builtin_ctzll(mask);
+        if ((mask = GetDiffMask(c, d))) return off + N + __builtin_ctzll(mask);
+    }
+
+    if (off + N <= Length) {
+        if ((mask = GetDiffMask(*reinterpret_cast<const VU*>(Left + off), *reinterpret_cast<const VU*>(Right + off))))
+            return off + __builtin_ctzll(mask);
+        off += N;
+    }
+
+    if (off < Length && (mask = GetDiffMask(*reinterpret_cast<const VU*>(Left + Length - N),
+                                            *reinterpret_cast<const VU*>(Right + Length - N))))
+        return Length - N + __builtin_ctzll(mask);
+
+    return Length;
+}
+
+template<class V> static disable_ubsan inline always_inline UIntPtr LengthLoop(const Char *Value) {
+    /* Aligned loads only (starting from the vector that contains the first character), so that we never cross into a
+     * page that the string doesn't touch (the bytes before the start of the string are just masked out). */
+
+    constexpr UIntPtr N = sizeof(V);
+    auto cur = reinterpret_cast<const UInt8*>(reinterpret_cast<UIntPtr>(Value) & ~(N - 1));
+    UIntPtr skip = reinterpret_cast<const UInt8*>(Value) - cur;
+    UInt64 full = N == 64 ? ~0ull : (1ull << N) - 1;
+    UInt64 mask = (GetDiffMask(*reinterpret_cast<const V*>(cur), V {}) ^ full) >> skip;
+
+    if (mask) return __builtin_ctzll(mask);
+
+    while (!(mask = GetDiffMask(*reinterpret_cast<const V*>(cur += N), V {}) ^ full)) ;
+
+    return cur - reinterpret_cast<const UInt8*>(Value) + __builtin_ctzll(mask);
+}
+
+template<class V> static disable_ubsan inline always_inline
+UIntPtr FindLoop(const UInt8 *Value, UIntPtr Length, const UInt8 *Set, UIntPtr SetLength) {
+    /* Offset of the first character that is in the set (or Length if there is none), for sets of up to 4 characters
+     * (if the set is smaller than that, we just repeat the last character). Everything else is just like
+     * MismatchLoop. */
+
+    typedef V VU aligned(1);
+    constexpr UIntPtr N = sizeof(V);
+
+    if constexpr (N > 16) {
+        if (Length < N) return FindLoop<UInt8x16>(Value, Length, Set, SetLength);
+    } else if (Length < N) {
+        for (UIntPtr i = 0; i < Length; i++) {
+            for (UIntPtr j = 0; j < SetLength; j++) if (Value[i] == Set[j]) return i;
+        }
+
+        return Length;
+    }
+
+    V s0 = V {} + Set[0], s1 = V {} + Set[SetLength > 1], s2 = V {} + Set[SetLength > 2 ? 2 : SetLength - 1],
+      s3 = V {} + Set[SetLength - 1];
+    UIntPtr off = 0;
+    UInt64 mask;
+
+    for (; off + N <= Length; off += N) {
+        V cur = *reinterpret_cast<const VU*>(Value + off);
+        if ((mask = GetDiffMask(__builtin_bit_cast(V, (cur == s0) | (cur == s1) | (cur == s2) | (cur == s3)), V {})))
+            return off + __builtin_ctzll(mask);
+    }
+
+    if (off < Length) {
+        V cur = *reinterpret_cast<const VU*>(Value + Length - N);
+        if ((mask = GetDiffMask(__builtin_bit_cast(V, (cur == s0) | (cur == s1) | (cur == s2) | (cur == s3)), V {})))
+            return Length - N + __builtin_ctzll(mask);
+    }
+
+    return Length;
+}
+
+static TARGET_GPR UIntPtr FindBitmap(const UInt8 *Value, UIntPtr Length, const UInt8 *Set, UIntPtr SetLength) {
+    /* Bigger sets: a bitmap of the set, and one lookup per character (this is also used by the GPR-only table, so it
+     * can't touch the vector registers, not even for zeroing the bitmap). */
+
+    UInt32 map[8] = {};
+
+    for (UIntPtr i = 0; i < SetLength; i++) map[Set[i] >> 5] |= 1u << (Set[i] & 0x1F);
+    for (UIntPtr i = 0; i < Length; i++) if (map[Value[i] >> 5] & (1u << (Value[i] & 0x1F))) return i;
+
+    return Length;
+}
+
+/* GPR-only versions, used whenever CR0.TS is set (interrupt handlers, and threads whose FPU state isn't on the
+ * registers, see Memory::GetFunctions). Everything here is compiled without the vector registers (so that the compiler
+ * can't sneak any SSE in), which is also why none of the templates above can be used. Anything big goes through rep
+ * movsb/stosb (which is fast on pretty much anything since the P6, even without ERMS), and non-temporal stores use
+ * MOVNTI. */
+
+#define GPR_REP_THRESHOLD 256
+
+static TARGET_GPR disable_ubsan Void StoreNonTemporal(UInt8 *Buffer, UIntPtr Value) {
+    asm volatile("movnti %1, %0" : "=m"(*reinterpret_cast<UIntPtr*>(Buffer)) : "r"(Value));
+}
+
+static TARGET_GPR disable_ubsan Void CopyGpr(Void *Buffer, const Void *Source, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    auto src = static_cast<const UInt8*>(Source);
+    constexpr UIntPtr N = sizeof(UIntPtr);
+
+    if (Length < N) {
+        if (Length >= 4) {
+            UInt32 a = *reinterpret_cast<const UInt32U*>(src), b = *reinterpret_cast<const UInt32U*>(src + Length - 4);
+            *reinterpret_cast<UInt32U*>(dst) = a, *reinterpret_cast<UInt32U*>(dst + Length - 4) = b;
+        } else if (Length) {
+            UInt8 a = src[0], b = src[Length >> 1], c = src[Length - 1];
+            dst[0] = a, dst[Length >> 1] = b, dst[Length - 1] = c;
+        }
+
+        return;
+    } else if (Length >= Memory::GetNonTemporalThreshold()) {
+        /* Same as CopyLoop: unaligned first/last words, and aligned (non-temporal) stores in the middle. */
+
+        typedef UIntPtr UIntPtrU aligned(1);
+        UIntPtr skip = -reinterpret_cast<UIntPtr>(dst) & (N - 1),
+                tail = *reinterpret_cast<const UIntPtrU*>(src + Length - N);
+
+        *reinterpret_cast<UIntPtrU*>(dst) = *reinterpret_cast<const UIntPtrU*>(src);
+
+        for (UIntPtr i = skip; i + N <= Length; i += N)
+            StoreNonTemporal(dst + i, *reinterpret_cast<const UIntPtrU*>(src + i));
+
+        asm volatile("sfence" ::: "memory");
+        *reinterpret_cast<UIntPtrU*>(dst + Length - N) = tail;
+    } else if (Length >= GPR_REP_THRESHOLD)
+        asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(Length) :: "memory");
+    else {
+        typedef UIntPtr UIntPtrU aligned(1);
+        for (UIntPtr i = 0; i + N < Length; i += N)
+            *reinterpret_cast<UIntPtrU*>(dst + i) = *reinterpret_cast<const UIntPtrU*>(src + i);
+        *reinterpret_cast<UIntPtrU*>(dst + Length - N) = *reinterpret_cast<const UIntPtrU*>(src + Length - N);
+    }
+}
+
+static TARGET_GPR disable_ubsan Void MoveGpr(Void *Buffer, const Void *Source, UIntPtr Length) {
+    /* Word at a time (plus whatever is left, byte by byte) in the direction that never reads something we already
+     * overwrote; rep movsb backwards (with the direction flag set) is way too slow to be of any use here. */
+
+    typedef UIntPtr UIntPtrU aligned(1);
+    auto dst = static_cast<UInt8*>(Buffer);
+    auto src = static_cast<const UInt8*>(Source);
+    constexpr UIntPtr N = sizeof(UIntPtr);
+    UIntPtr i = 0;
+
+    if (dst + Length <= src || src + Length <= dst) CopyGpr(Buffer, Source, Length);
+    else if (dst < src) {
+        for (; i + N <= Length; i += N)
+            *reinterpret_cast<UIntPtrU*>(dst + i) = *reinterpret_cast<const UIntPtrU*>(src + i);
+        for (; i < Length; i++) dst[i] = src[i];
+    } else {
+        for (i = Length; i >= N; i -= N)
+            *reinterpret_cast<UIntPtrU*>(dst + i - N) = *reinterpret_cast<const UIntPtrU*>(src + i - N);
+        for (; i; i--) dst[i - 1] = src[i - 1];
+    }
+}
+
+static TARGET_GPR disable_ubsan Void FillGpr(UInt8 *Buffer, UInt64 Small, UIntPtr Length) {
+    /* Shared by the two set functions (Small is the pattern repeated over 8 bytes, and Length is always a multiple of
+     * the period, so all the overlapping stores are at a multiple of the period from the start). */
+
+    typedef UIntPtr UIntPtrU aligned(1);
+    constexpr UIntPtr N = sizeof(UIntPtr);
+    auto word = static_cast<UIntPtr>(Small);
+
+    if (Length >= N) {
+        for (UIntPtr i = 0; i + N < Length; i += N) *reinterpret_cast<UIntPtrU*>(Buffer + i) = word;
+        *reinterpret_cast<UIntPtrU*>(Buffer + Length - N) = word;
+    } else if (Length >= 4) {
+        *reinterpret_cast<UInt32U*>(Buffer) = Small;
+        *reinterpret_cast<UInt32U*>(Buffer + Length - 4) = Small;
+    } else if (Length) Buffer[0] = Buffer[Length >> 1] = Buffer[Length - 1] = Small;
+}
+
+static TARGET_GPR disable_ubsan Void FillNonTemporalGpr(UInt8 *Buffer, UInt64 Small, UIntPtr Length) {
+    /* Only used when Buffer is aligned to the period of the pattern (so aligning it further keeps the pattern). */
+
+    typedef UIntPtr UIntPtrU aligned(1);
+    constexpr UIntPtr N = sizeof(UIntPtr);
+    auto word = static_cast<UIntPtr>(Small);
+    UIntPtr skip = -reinterpret_cast<UIntPtr>(Buffer) & (N - 1);
+
+    *reinterpret_cast<UIntPtrU*>(Buffer) = word;
+    for (UIntPtr i = skip; i + N <= Length; i += N) StoreNonTemporal(Buffer + i, word);
+    asm volatile("sfence" ::: "memory");
+    *reinterpret_cast<UIntPtrU*>(Buffer + Length - N) = word;
+}
+
+static TARGET_GPR disable_ubsan Void SetGpr(Void *Buffer, UInt8 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+
+    if (Length >= Memory::GetNonTemporalThreshold() && Length >= sizeof(UIntPtr))
+        FillNonTemporalGpr(dst, Value * 0x0101010101010101ull, Length);
+    else if (Length >= GPR_REP_THRESHOLD) asm volatile("rep stosb" : "+D"(dst), "+c"(Length) : "a"(Value) : "memory");
+    else FillGpr(dst, Value * 0x0101010101010101ull, Length);
+}
+
+static TARGET_GPR disable_ubsan Void Set32Gpr(Void *Buffer, UInt32 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt64 small = Value | (static_cast<UInt64>(Value) << 32);
+
+    if ((Length << 2) >= Memory::GetNonTemporalThreshold() && (Length << 2) >= sizeof(UIntPtr) &&
+        !(reinterpret_cast<UIntPtr>(dst) & 3)) FillNonTemporalGpr(dst, small, Length << 2);
+    else if ((Length << 2) >= GPR_REP_THRESHOLD)
+        asm volatile("rep stosl" : "+D"(dst), "+c"(Length) : "a"(Value) : "memory");
+    else FillGpr(dst, small, Length << 2);
+}
+
+static TARGET_GPR disable_ubsan UIntPtr MismatchGpr(const Void *Left, const Void *Right, UIntPtr Length) {
+    typedef UIntPtr UIntPtrU aligned(1);
+    auto left = static_cast<const UInt8*>(Left);
+    auto right = static_cast<const UInt8*>(Right);
+    constexpr UIntPtr N = sizeof(UIntPtr);
+    UIntPtr i = 0, diff;
+
+    for (; i + N <= Length; i += N)
+        if ((diff = *reinterpret_cast<const UIntPtrU*>(left + i) ^ *reinterpret_cast<const UIntPtrU*>(right + i)))
+            return i + (__builtin_ctzll(diff) >> 3);
+
+    for (; i < Length; i++) if (left[i] != right[i]) return i;
+
+    return Length;
+}
+
+static TARGET_GPR disable_ubsan UIntPtr LengthGpr(const Char *Value) {
+    /* Aligned words (so, just like LengthLoop, we never cross into a page that the string doesn't touch), with the
+     * usual "does this word have a zero byte" trick; the bytes before the start of the string are forced to be
+     * non-zero. The lowest flagged byte is always the first zero (the trick can only give false positives above a real
+     * zero byte). */
+
+    constexpr UIntPtr N = sizeof(UIntPtr);
+    constexpr UIntPtr ones = static_cast<UIntPtr>(0x0101010101010101ull), highs = ones << 7;
+    auto cur = reinterpret_cast<const UIntPtr*>(reinterpret_cast<UIntPtr>(Value) & ~(N - 1));
+    UIntPtr skip = reinterpret_cast<const UInt8*>(Value) - reinterpret_cast<const UInt8*>(cur);
+    UIntPtr word = *cur | (skip ? (static_cast<UIntPtr>(1) << (skip << 3)) - 1 : 0), mask;
+
+    while (!(mask = (word - ones) & ~word & highs)) word = *++cur;
+
+    return reinterpret_cast<const UInt8*>(cur) - reinterpret_cast<const UInt8*>(Value) + (__builtin_ctzll(mask) >> 3);
+}
+
+static TARGET_GPR disable_ubsan UIntPtr FindGpr(const Char *Value, UIntPtr Length, const Char *Set,
+                                                UIntPtr SetLength) {
+    auto val = reinterpret_cast<const UInt8*>(Value);
+    auto set = reinterpret_cast<const UInt8*>(Set);
+
+    if (SetLength > 4) return FindBitmap(val, Length, set, SetLength);
+
+    UInt8 s0 = set[0], s1 = set[SetLength > 1], s2 = set[SetLength > 2 ? 2 : SetLength - 1], s3 = set[SetLength - 1];
+
+    for (UIntPtr i = 0; i < Length; i++)
+        if (val[i] == s0 || val[i] == s1 || val[i] == s2 || val[i] == s3) return i;
+
+    return Length;
+}
+
+/* SSE2 (the baseline, every amd64 processor has it, and we require it on x86 as well). */
+
+static disable_ubsan Void CopySse2(Void *Buffer, const Void *Source, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    auto src = static_cast<const UInt8*>(Source);
+
+    if (Length >= Memory::GetNonTemporalThreshold()) CopyLoop<UInt8x16, True>(dst, src, Length);
+    else CopyLoop<UInt8x16>(dst, src, Length);
+}
+
+static disable_ubsan Void MoveSse2(Void *Buffer, const Void *Source, UIntPtr Length) {
+    MoveLoop<UInt8x16>(static_cast<UInt8*>(Buffer), static_cast<const UInt8*>(Source), Length);
+}
+
+static disable_ubsan UIntPtr MismatchSse2(const Void *Left, const Void *Right, UIntPtr Length) {
+    return MismatchLoop<UInt8x16>(static_cast<const UInt8*>(Left), static_cast<const UInt8*>(Right), Length);
+}
+
+static disable_ubsan UIntPtr LengthSse2(const Char *Value) {
+    return LengthLoop<UInt8x16>(Value);
+}
+
+static disable_ubsan UIntPtr FindSse2(const Char *Value, UIntPtr Length, const Char *Set,
+                                      UIntPtr SetLength) {
+    auto val = reinterpret_cast<const UInt8*>(Value);
+    auto set = reinterpret_cast<const UInt8*>(Set);
+    return SetLength > 4 ? FindBitmap(val, Length, set, SetLength) : FindLoop<UInt8x16>(val, Length, set, SetLength);
+}
+
+static disable_ubsan Void SetSse2(Void *Buffer, UInt8 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x16 pat = UInt8x16 {} + Value;
+    UInt64 small = Value * 0x0101010101010101ull;
+
+    if (Length >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x16, True>(dst, pat, small, 1, Length);
+    else FillLoop<UInt8x16>(dst, pat, small, 1, Length);
+}
+
+static disable_ubsan Void Set32Sse2(Void *Buffer, UInt32 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x16 pat = __builtin_bit_cast(UInt8x16, UInt32x4 {} + Value);
+    UInt64 small = Value | (static_cast<UInt64>(Value) << 32);
+
+    if ((Length << 2) >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x16, True>(dst, pat, small, 4, Length << 2);
+    else FillLoop<UInt8x16>(dst, pat, small, 4, Length << 2);
+}
+
+/* AVX2 (32-byte vectors). */
+
+static TARGET_AVX2 disable_ubsan Void CopyAvx2(Void *Buffer, const Void *Source, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    auto src = static_cast<const UInt8*>(Source);
+
+    if (Length >= Memory::GetNonTemporalThreshold()) CopyLoop<UInt8x32, True>(dst, src, Length);
+    else CopyLoop<UInt8x32>(dst, src, Length);
+}
+
+static TARGET_AVX2 disable_ubsan Void MoveAvx2(Void *Buffer, const Void *Source, UIntPtr Length) {
+    MoveLoop<UInt8x32>(static_cast<UInt8*>(Buffer), static_cast<const UInt8*>(Source), Length);
+}
+
+static TARGET_AVX2 disable_ubsan UIntPtr MismatchAvx2(const Void *Left, const Void *Right, UIntPtr Length) {
+    return MismatchLoop<UInt8x32>(static_cast<const UInt8*>(Left), static_cast<const UInt8*>(Right), Length);
+}
+
+static TARGET_AVX2 disable_ubsan UIntPtr LengthAvx2(const Char *Value) {
+    return LengthLoop<UInt8x32>(Value);
+}
+
+static TARGET_AVX2 disable_ubsan UIntPtr FindAvx2(const Char *Value, UIntPtr Length, const Char *Set,
+                                                  UIntPtr SetLength) {
+    auto val = reinterpret_cast<const UInt8*>(Value);
+    auto set = reinterpret_cast<const UInt8*>(Set);
+    return SetLength > 4 ? FindBitmap(val, Length, set, SetLength) : FindLoop<UInt8x32>(val, Length, set, SetLength);
+}
+
+static TARGET_AVX2 disable_ubsan Void SetAvx2(Void *Buffer, UInt8 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x32 pat = UInt8x32 {} + Value;
+    UInt64 small = Value * 0x0101010101010101ull;
+
+    if (Length >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x32, True>(dst, pat, small, 1, Length);
+    else FillLoop<UInt8x32>(dst, pat, small, 1, Length);
+}
+
+static TARGET_AVX2 disable_ubsan Void Set32Avx2(Void *Buffer, UInt32 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x32 pat = __builtin_bit_cast(UInt8x32, UInt32x8 {} + Value);
+    UInt64 small = Value | (static_cast<UInt64>(Value) << 32);
+
+    if ((Length << 2) >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x32, True>(dst, pat, small, 4, Length << 2);
+    else FillLoop<UInt8x32>(dst, pat, small, 4, Length << 2);
+}
+
+/* AVX-512 (64-byte vectors, we also need BW for the byte-granular operations). */
+
+static TARGET_AVX512 disable_ubsan Void CopyAvx512(Void *Buffer, const Void *Source, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    auto src = static_cast<const UInt8*>(Source);
+
+    if (Length >= Memory::GetNonTemporalThreshold()) CopyLoop<UInt8x64, True>(dst, src, Length);
+    else CopyLoop<UInt8x64>(dst, src, Length);
+}
+
+static TARGET_AVX512 disable_ubsan Void MoveAvx512(Void *Buffer, const Void *Source, UIntPtr Length) {
+    MoveLoop<UInt8x64>(static_cast<UInt8*>(Buffer), static_cast<const UInt8*>(Source), Length);
+}
+
+static TARGET_AVX512 disable_ubsan UIntPtr MismatchAvx512(const Void *Left, const Void *Right, UIntPtr Length) {
+    return MismatchLoop<UInt8x64>(static_cast<const UInt8*>(Left), static_cast<const UInt8*>(Right), Length);
+}
+
+static TARGET_AVX512 disable_ubsan UIntPtr LengthAvx512(const Char *Value) {
+    return LengthLoop<UInt8x64>(Value);
+}
+
+static TARGET_AVX512 disable_ubsan UIntPtr FindAvx512(const Char *Value, UIntPtr Length, const Char *Set,
+                                                      UIntPtr SetLength) {
+    auto val = reinterpret_cast<const UInt8*>(Value);
+    auto set = reinterpret_cast<const UInt8*>(Set);
+    return SetLength > 4 ? FindBitmap(val, Length, set, SetLength) : FindLoop<UInt8x64>(val, Length, set, SetLength);
+}
+
+static TARGET_AVX512 disable_ubsan Void SetAvx512(Void *Buffer, UInt8 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x64 pat = UInt8x64 {} + Value;
+    UInt64 small = Value * 0x0101010101010101ull;
+
+    if (Length >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x64, True>(dst, pat, small, 1, Length);
+    else FillLoop<UInt8x64>(dst, pat, small, 1, Length);
+}
+
+static TARGET_AVX512 disable_ubsan Void Set32Avx512(Void *Buffer, UInt32 Value, UIntPtr Length) {
+    auto dst = static_cast<UInt8*>(Buffer);
+    UInt8x64 pat = __builtin_bit_cast(UInt8x64, UInt32x16 {} + Value);
+    UInt64 small = Value | (static_cast<UInt64>(Value) << 32);
+
+    if ((Length << 2) >= Memory::GetNonTemporalThreshold()) FillLoop<UInt8x64, True>(dst, pat, small, 4, Length << 2);
+    else FillLoop<UInt8x64>(dst, pat, small, 4, Length << 2);
+}
+
+/* ERMS (enhanced rep movsb/stosb): the microcode is faster than any vector loop for big copies/sets, but it has some
+ * startup cost, so anything smaller than the threshold still goes through the vector code (FSRM, fast short rep movsb,
+ * makes that cost much smaller). Really big copies/sets still go through the vector code, as rep movsb/stosb would
+ * go through the caches (while the vector code uses non-temporal stores at that point). */
+
+static UIntPtr ErmsThreshold = 2048;
+static Void (*ErmsCopy)(Void*, const Void*, UIntPtr) = CopySse2;
+static Void (*ErmsSet)(Void*, UInt8, UIntPtr) = SetSse2;
+
+static disable_ubsan Void CopyErms(Void *Buffer, const Void *Source, UIntPtr Length) {
+    if (Length < ErmsThreshold || Length >= Memory::GetNonTemporalThreshold()) ErmsCopy(Buffer, Source, Length);
+    else asm volatile("rep movsb" : "+D"(Buffer), "+S"(Source), "+c"(Length) :: "memory");
+}
+
+static disable_ubsan Void SetErms(Void *Buffer, UInt8 Value, UIntPtr Length) {
+    if (Length < ErmsThreshold || Length >= Memory::GetNonTemporalThreshold()) ErmsSet(Buffer, Value, Length);
+    else asm volatile("rep stosb" : "+D"(Buffer), "+c"(Length) : "a"(Value) : "memory");
+}
+
+/* MoveMemory is only different from CopyMemory if the regions overlap (if they don't, we can use the selected copy
+ * function, which might be rep movsb). */
+
+static Void (*MoveOverlap)(Void*, const Void*, UIntPtr) = MoveSse2;
+
+static disable_ubsan Void MoveDispatch(Void *Buffer, const Void *Source, UIntPtr Length) {
+    auto buf = reinterpret_cast<UIntPtr>(Buffer), src = reinterpret_cast<UIntPtr>(Source);
+
+    if (buf + Length <= src || src + Length <= buf) Memory::GetFunctions().Copy(Buffer, Source, Length);
+    else MoveOverlap(Buffer, Source, Length);
+}
+
+MemoryFunctions Memory::Functions { "SSE2", False, CopySse2, SetSse2, Set32Sse2, MoveDispatch, MismatchSse2, LengthSse2,
+                                     FindSse2 };
+MemoryFunctions Memory::Scalar { "GPR", False, CopyGpr, SetGpr, Set32Gpr, MoveGpr, MismatchGpr, LengthGpr, FindGpr };
+UIntPtr Memory::NonTemporalThreshold = UINTPTR_MAX;
+
+static UIntPtr GetCacheSize(UInt32 Max) {
+    /* Size of the last level cache: Intel has the deterministic cache parameters leaf (with one subleaf per cache), AMD
+     * only has the (simpler) extended L2/L3 leaf. */
+
+    UInt32 ax, bx, cx, dx, level = 0;
+    UIntPtr size = 0;
+
+    for (UInt32 i = 0; Max >= 4 && i < 16; i++) {
+        asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(4), "c"(i));
+        if (!(ax & 0x1F)) break;
+        else if (((ax >> 5) & 0x07) < level) continue;
+
+        level = (ax >> 5) & 0x07;
+        size = static_cast<UIntPtr>((bx >> 22) + 1) * (((bx >> 12) & 0x3FF) + 1) * ((bx & 0xFFF) + 1) * (cx + 1);
+    }
+
+    if (size) return size;
+
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x80000000));
+    if (ax < 0x80000006) return 0;
+
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x80000006));
+    return dx >> 18 ? static_cast<UIntPtr>(dx >> 18) << 19 : static_cast<UIntPtr>(cx >> 16) << 10;
+}
+
+Void Memory::Initialize(Void) {
+    /* AVX2 and AVX-512 need both the processor support (CPUID leaf 7) and the OS support (the relevant state enabled on
+     * XCR0), AVX-512 needs the opmask and both halves of the ZMM state. ERMS/FSRM are independent of all that (and we
+     * use them on top of whatever vector level we picked). */
+
+    UInt32 max, ax, bx, cx, dx, cx1, bx7 = 0, dx7 = 0;
+    UInt64 xcr0 = 0;
+
+    asm volatile("cpuid" : "=a"(max), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx1), "=d"(dx) : "a"(1));
+
+    if (max >= 7) asm volatile("cpuid" : "=a"(ax), "=b"(bx7), "=c"(cx), "=d"(dx7) : "a"(7), "c"(0));
+
+    if (cx1 & 0x8000000) {
+        asm volatile("xgetbv" : "=a"(ax), "=d"(dx) : "c"(0));
+        xcr0 = ax | (static_cast<UInt64>(dx) << 32);
+    }
+
+    if ((bx7 & 0x40010020) == 0x40010020 && (xcr0 & 0xE6) == 0xE6) {
+        Functions = { "AVX-512", False, CopyAvx512, SetAvx512, Set32Avx512, MoveDispatch, MismatchAvx512, LengthAvx512,
+                      FindAvx512 };
+        MoveOverlap = MoveAvx512;
+    } else if ((bx7 & 0x20) && (cx1 & 0x10000000) && (xcr0 & 0x06) == 0x06) {
+        Functions = { "AVX2", False, CopyAvx2, SetAvx2, Set32Avx2, MoveDispatch, MismatchAvx2, LengthAvx2,
+                      FindAvx2 };
+        MoveOverlap = MoveAvx2;
+    }
+
+    /* Anything bigger than 3/4 of the LLC would just evict everything else from it (and most of itself as well), so
+     * we use non-temporal stores for those (if we don't know the cache size, we never use them). test/cache.cxx
+     * measures both the pollution and the throughput of each side of the threshold. */
+
+    UIntPtr llc = GetCacheSize(max);
+    if (llc) NonTemporalThreshold = llc - (llc >> 2);
+
+    if (bx7 & 0x200) {
+        ErmsThreshold = dx7 & 0x10 ? 128 : 2048;
+        ErmsCopy = Functions.Copy;
+        ErmsSet = Functions.Set;
+        Functions.Erms = True;
+        Functions.Copy = CopyErms;
+        Functions.Set = SetErms;
+    }
+}
+
+}
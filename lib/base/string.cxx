@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 05 of 2021, at 10:21 BRT
- * Last edited on July 06 of 2021 at 19:43 BRT */
+ * Last edited on October 19 of 2026 at 22:10 BRT */
 
 #include <base/string.hxx>
 
@@ -23,9 +23,11 @@ String::String(UIntPtr Length) : String() {
              Capacity = len + 1; \
              Length = ViewEnd = len; \
              CopyMemory(this->Value, val, len); \
+             this->Value[len] = 0; \
          } else if (len <= 16) { \
              Length = ViewEnd = len; \
-             CopyMemory(Small, val, len + 1); \
+             CopyMemory(Small, val, len); \
+             Small[len] = 0; \
          } } while (False)
 
 String::String(const Char *Value) : String() {
@@ -174,6 +176,44 @@ Status String::Append(Char Value) {
     return Status::Success;
 }
 
+Status String::AppendRaw(const Char *Data, UIntPtr Size) {
+    /* Same thing as above, but for a whole span of characters at once (so we only need to grow the buffer once, which
+     * also makes the formatted appends way faster). Data may point into ourselves, so the old buffer can only be freed
+     * after the copy. */
+
+    if (Data == Null || !Size) return Status::Success;
+
+    if (!Capacity && Length + Size < 16) {
+        CopyMemory(&Small[Length], Data, Size);
+        Length += Size;
+        Small[Length] = 0;
+    } else {
+        if (!Capacity || Length + Size >= Capacity) {
+            UIntPtr nlen = Length < 4 ? 4 : Length * 2 + 1;
+            if (nlen < Length + Size + 1) nlen = Length + Size + 1;
+
+            Char *buf = new Char[nlen];
+
+            if (buf == Null) return Status::OutOfMemory;
+            else if (Length) CopyMemory(buf, Capacity ? this->Value : Small, Length);
+
+            CopyMemory(&buf[Length], Data, Size);
+            if (Capacity) delete[] this->Value;
+
+            this->Value = buf;
+            Capacity = nlen;
+        } else MoveMemory(&this->Value[Length], Data, Size);
+
+        Length += Size;
+        this->Value[Length] = 0;
+    }
+
+    ViewStart = 0;
+    ViewEnd = Length;
+
+    return Status::Success;
+}
+
 Char *String::GetValue() const {
     Char *str = GetViewLength() ? new Char[GetViewLength() + 1] : Null;
     if (str != Null) CopyMemory(str, (Capacity ? Value : Small) + ViewStart, GetViewLength() + 1);
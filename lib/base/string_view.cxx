@@ -1,9 +1,10 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 05 of 2021, at 16:12 BRT
- * Last edited on July 06 of 2021 at 19:45 BRT */
+ * Last edited on October 20 of 2026 at 11:20 BRT */
 
 #include <base/string.hxx>
+#include <util/memory.hxx>
 
 using namespace CHicago;
 
@@ -35,124 +36,349 @@ StringView StringView::FromStatus(Status Code) {
     }
 }
 
+static const Char Digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static const Char DigitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                                 "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                                 "8081828384858687888990919293949596979899";
+
+static const UInt64 Pow10[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000, 10000000000, 100000000000,
+    1000000000000, 10000000000000, 100000000000000, 1000000000000000, 10000000000000000, 100000000000000000,
+    1000000000000000000, 10000000000000000000u
+};
+
 static UIntPtr CountDigits(UInt64 Value, UInt8 Base) {
+    /* Base 10 doesn't need any division: the bit length times log10(2) (~1233/4096) gives us the digit count, or one
+     * less than it, and one compare against the power table fixes that. Power of two bases are even easier (each digit
+     * is a fixed amount of bits). */
+
     if (!Value) return 1;
 
-    UIntPtr ret = 0;
+    UIntPtr bits = 64 - __builtin_clzll(Value), ret = 0;
+
+    if (Base == 10) {
+        ret = (bits * 1233) >> 12;
+        return ret + (Value >= Pow10[ret]);
+    } else if (!(Base & (Base - 1))) {
+        UIntPtr shift = __builtin_ctz(Base);
+        return (bits + shift - 1) / shift;
+    }
+
     for (; Value; Value /= Base, ret++) ;
 
     return ret;
 }
 
+static inline Void WritePair(Char *Buffer, UInt32 Value) {
+    Buffer[0] = DigitPairs[Value * 2];
+    Buffer[1] = DigitPairs[Value * 2 + 1];
+}
+
 static Void FromUInt(Char *Buffer, UInt64 Value, UInt8 Base, IntPtr &Current, IntPtr End) {
-    for (; Current >= End && Value; Current--, Value /= Base)
-        Buffer[Current] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[Value % Base];
+    /* Base 10 goes two digits at a time (using the pair table), and anything that doesn't fit in 32-bits is first split
+     * into chunks of 8 digits, so that most of the divisions are 32-bit ones (on x86, 64-bit divisions are calls into
+     * libgcc). Power of two bases don't need any division. Whatever is left (or doesn't fit between Current and End)
+     * goes through the generic one-digit-at-a-time loop. */
+
+    if (Base == 10) {
+        for (; Value > 0xFFFFFFFF && Current - 7 >= End; Current -= 8) {
+            UInt64 quot = Value / 100000000;
+            auto chunk = static_cast<UInt32>(Value - quot * 100000000);
+
+            Value = quot;
+
+            for (IntPtr i = Current - 1; i > Current - 8; i -= 2, chunk /= 100) WritePair(&Buffer[i], chunk % 100);
+        }
+
+        if (Value <= 0xFFFFFFFF) {
+            auto val = static_cast<UInt32>(Value);
+            for (; val >= 10 && Current - 1 >= End; Current -= 2, val /= 100)
+                WritePair(&Buffer[Current - 1], val % 100);
+            Value = val;
+        }
+    } else if (!(Base & (Base - 1))) {
+        UIntPtr shift = __builtin_ctz(Base);
+        for (; Current >= End && Value; Current--, Value >>= shift) Buffer[Current] = Digits[Value & (Base - 1)];
+    }
+
+    for (; Current >= End && Value; Current--, Value /= Base) Buffer[Current] = Digits[Value % Base];
 }
 
 StringView StringView::FromInt(Char *Buffer, Int64 Value, UIntPtr Size) {
-    /* Extract the sign (we gonna plot it at the end), and do a basic buffer size checks. */
+    /* Extract the sign (we gonna plot it at the end), and do a basic buffer size checks (the magnitude is calculated
+     * as unsigned, so that INT64_MIN also works). */
 
-    Int64 sign = Value < 0 ? -1 : 1;
-    Value *= sign;
+    UInt64 uval = Value < 0 ? -static_cast<UInt64>(Value) : Value;
 
-    if (Buffer == Null || (Value && Size < CountDigits(Value, 10) + (sign < 0 ? 1 : 0) + 1)) return {};
+    if (Buffer == Null || (Value && Size < CountDigits(uval, 10) + (Value < 0 ? 1 : 0) + 1)) return {};
     else if (!Value) return "0";
 
-    /* Now with the easy cases out of the way, let's first handle saving the sign, and converting the value into a
-     * positive value. */
-
-    IntPtr cur = static_cast<IntPtr>(Size - 2), end = sign < 0 ? 1 : 0;
-
     /* Now we can just use our global FromUInt function (as the value is now a valid UInt), add the sign (if required),
      * and return! */
 
-    ::FromUInt(Buffer, Value, 10, cur, end);
-    if (sign) Buffer[cur--] = '-';
+    IntPtr cur = static_cast<IntPtr>(Size - 2), end = Value < 0 ? 1 : 0;
+
+    Buffer[Size - 1] = 0;
+    ::FromUInt(Buffer, uval, 10, cur, end);
+    if (Value < 0) Buffer[cur--] = '-';
 
     return &Buffer[cur + 1];
 }
 
 StringView StringView::FromUInt(Char *Buffer, UInt64 Value, UIntPtr Size, UInt8 Base) {
-    if (Buffer == Null || Base < 2 || Base > 36 || (Value && Size < CountDigits(Value, Base) + 1)) return {};
+    /* 64 digits (plus the NUL) is the most that any base can take, so we only need to count the digits if the buffer
+     * is smaller than that. */
+
+    if (Buffer == Null || Base < 2 || Base > 36 || (Value && Size < 65 && Size < CountDigits(Value, Base) + 1))
+        return {};
     else if (!Value) return "0";
 
     /* As the UInt value is always positive, we can just call the int function and return (no need to handle the val
      * sign). */
 
     auto cur = static_cast<IntPtr>(Size - 2);
+
+    Buffer[Size - 1] = 0;
     ::FromUInt(Buffer, Value, Base, cur, 0);
 
     return &Buffer[cur + 1];
 }
 
-static Float Pow10Neg[] = {
-        0.5, 0.05, 0.005, 0.0005, 0.00005, 0.000005, 0.0000005, 0.00000005, 0.000000005, 0.0000000005, 0.00000000005,
-        0.000000000005, 0.0000000000005, 0.00000000000005, 0.000000000000005, 0.0000000000000005, 0.00000000000000005,
-        0.000000000000000005
-};
+/* Floats are converted using Ryu (by Ulf Adams, see https://github.com/ulfjack/ryu): it gives us the shortest decimal
+ * mantissa/exponent that still round trips into the same float, using a few 64x128-bit multiplies against the tables
+ * in floatdata.cxx (instead of the old way of repeatedly multiplying the fraction by 10, which accumulated error on
+ * every digit). */
 
-static Boolean IsInfinite(Float Value) {
-    /* According to IEEE-754, we know that a number is infinite if all the exponent bits are 1, and all the fraction
-     * bits are 0, and then we can just check the sign bit to know if it is -inf or +inf. */
+namespace CHicago { extern const UInt64 FloatPow5Split[326][2], FloatPow5InvSplit[342][2]; }
 
-    union { Float FloatValue; UInt64 IntValue; } val { .FloatValue = Value };
-    return !(val.IntValue & 0xFFFFFFFFFFFFF) && (val.IntValue & 0x7FF0000000000000) == 0x7FF0000000000000;
+static inline Int32 Pow5Bits(Int32 Exponent) {
+    return static_cast<Int32>((static_cast<UInt32>(Exponent) * 1217359) >> 19) + 1;
 }
 
-static Boolean IsNaN(Float Value) {
-    /* And for checking NaNs, it's similar, but the fraction has to be anything except all zeroes. */
+static inline UInt32 Log10Pow2(Int32 Exponent) { return (static_cast<UInt32>(Exponent) * 78913) >> 18; }
+static inline UInt32 Log10Pow5(Int32 Exponent) { return (static_cast<UInt32>(Exponent) * 732923) >> 20; }
+static inline Boolean IsMultipleOfPow2(UInt64 Value, UInt32 Power) { return !(Value & ((1ull << Power) - 1)); }
 
-    union { Float FloatValue; UInt64 IntValue; } val { .FloatValue = Value };
-    return (val.IntValue & 0xFFFFFFFFFFFFF) && (val.IntValue & 0x7FF0000000000000) == 0x7FF0000000000000;
+static inline Boolean IsMultipleOfPow5(UInt64 Value, UInt32 Power) {
+    UInt32 count = 0;
+    for (; !(Value % 5); Value /= 5, count++) ;
+    return count >= Power;
+}
+
+static inline UInt64 MultiplyShift(UInt64 Value, const UInt64 *Multiplier, Int32 Shift) {
+    /* (Value * Multiplier) >> Shift, where Multiplier is 128-bits and the result always fits in 64-bits. Shift is
+     * always bigger than 64 (so the low 64-bits of the first product only matter for their carry). x86 doesn't have
+     * __int128, so there we have to build the 64x64 multiplies out of 32x32 ones. */
+
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 low = static_cast<unsigned __int128>(Value) * Multiplier[0],
+                      high = static_cast<unsigned __int128>(Value) * Multiplier[1];
+    return static_cast<UInt64>(((low >> 64) + high) >> (Shift - 64));
+#else
+    auto mul = [](UInt64 A, UInt64 B, UInt64 &High) -> UInt64 {
+        UInt64 ll = static_cast<UInt64>(static_cast<UInt32>(A)) * static_cast<UInt32>(B),
+               lh = static_cast<UInt64>(static_cast<UInt32>(A)) * static_cast<UInt32>(B >> 32),
+               hl = static_cast<UInt64>(static_cast<UInt32>(A >> 32)) * static_cast<UInt32>(B),
+               hh = static_cast<UInt64>(static_cast<UInt32>(A >> 32)) * static_cast<UInt32>(B >> 32),
+               mid = (ll >> 32) + static_cast<UInt32>(lh) + static_cast<UInt32>(hl);
+        High = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+        return (mid << 32) | static_cast<UInt32>(ll);
+    };
+
+    UInt64 high0, high1, low1 = mul(Value, Multiplier[1], high1), sum;
+
+    mul(Value, Multiplier[0], high0);
+    sum = high0 + low1;
+    high1 += sum < high0;
+    Shift -= 64;
+
+    return Shift >= 64 ? high1 >> (Shift - 64) : (!Shift ? sum : (high1 << (64 - Shift)) | (sum >> Shift));
+#endif
+}
+
+static Void ToDecimal(UInt64 Fraction, UInt32 Exponent, UInt64 &Mantissa, Int32 &Decimal) {
+    /* Step 1: Decode the float (and, if it is an integer smaller than 2^53, we can just use it directly, after removing
+     * the trailing zeroes). */
+
+    Int32 e2 = Exponent ? static_cast<Int32>(Exponent) - 1023 - 52 : 1 - 1023 - 52;
+    UInt64 m2 = Exponent ? (1ull << 52) | Fraction : Fraction;
+
+    if (e2 <= 0 && e2 >= -52 && !(m2 & ((1ull << -e2) - 1))) {
+        for (Mantissa = m2 >> -e2, Decimal = 0; !(Mantissa % 10); Mantissa /= 10, Decimal++) ;
+        return;
+    }
+
+    /* Step 2: The interval of valid decimal representations is [mm, mp] (scaled by 4 so that everything is an
+     * integer), the bounds are only valid if the mantissa is even (round-to-even while parsing). */
+
+    e2 -= 2;
+
+    Boolean even = !(m2 & 1), vmZeros = False, vrZeros = False;
+    UInt64 mv = m2 * 4, vr, vp, vm;
+    UInt32 shift = Fraction || Exponent <= 1;
+    Int32 e10;
+
+    /* Step 3: Convert the interval into base 10 (using the tables), keeping track of whether we dropped only zeroes
+     * while doing so (which is required for the rounding to be correct). */
+
+    if (e2 >= 0) {
+        UInt32 q = Log10Pow2(e2) - (e2 > 3);
+        Int32 i = -e2 + static_cast<Int32>(q) + 125 + Pow5Bits(q) - 1;
+
+        e10 = static_cast<Int32>(q);
+        vr = MultiplyShift(mv, FloatPow5InvSplit[q], i);
+        vp = MultiplyShift(mv + 2, FloatPow5InvSplit[q], i);
+        vm = MultiplyShift(mv - 1 - shift, FloatPow5InvSplit[q], i);
+
+        if (q <= 21) {
+            if (!(mv % 5)) vrZeros = IsMultipleOfPow5(mv, q);
+            else if (even) vmZeros = IsMultipleOfPow5(mv - 1 - shift, q);
+            else vp -= IsMultipleOfPow5(mv + 2, q);
+        }
+    } else {
+        UInt32 q = Log10Pow5(-e2) - (-e2 > 1);
+        Int32 i = -e2 - static_cast<Int32>(q), j = static_cast<Int32>(q) - (Pow5Bits(i) - 125);
+
+        e10 = static_cast<Int32>(q) + e2;
+        vr = MultiplyShift(mv, FloatPow5Split[i], j);
+        vp = MultiplyShift(mv + 2, FloatPow5Split[i], j);
+        vm = MultiplyShift(mv - 1 - shift, FloatPow5Split[i], j);
+
+        if (q <= 1) {
+            vrZeros = True;
+            if (even) vmZeros = shift == 1;
+            else vp--;
+        } else if (q < 63) vrZeros = IsMultipleOfPow2(mv, q);
+    }
+
+    /* Step 4: Find the shortest representation inside the interval (removing digits while the bounds still differ),
+     * and round it correctly. The first case (where we have to care about trailing zeroes) is pretty rare. */
+
+    Int32 removed = 0;
+    UInt32 last = 0;
+
+    if (vmZeros || vrZeros) {
+        for (; vp / 10 > vm / 10; vr /= 10, vp /= 10, vm /= 10, removed++) {
+            vmZeros &= !(vm % 10);
+            vrZeros &= !last;
+            last = vr % 10;
+        }
+
+        if (vmZeros) {
+            for (; !(vm % 10); vr /= 10, vp /= 10, vm /= 10, removed++) {
+                vrZeros &= !last;
+                last = vr % 10;
+            }
+        }
+
+        if (vrZeros && last == 5 && !(vr & 1)) last = 4;
+
+        Mantissa = vr + ((vr == vm && (!even || !vmZeros)) || last >= 5);
+    } else {
+        Boolean up = False;
+
+        if (vp / 100 > vm / 100) {
+            up = vr % 100 >= 50;
+            vr /= 100, vp /= 100, vm /= 100, removed += 2;
+        }
+
+        for (; vp / 10 > vm / 10; vr /= 10, vp /= 10, vm /= 10, removed++) up = vr % 10 >= 5;
+
+        Mantissa = vr + (vr == vm || up);
+    }
+
+    Decimal = e10 + removed;
 }
 
 StringView StringView::FromFloat(Char *Buffer, Float Value, UIntPtr Size, UIntPtr Precision) {
-    /* First, check for infinite and nan (as we have to handle those in a different way), and after that, limit the max
-     * precision to 17 (trying to print more than this is a bit useless/starts to lose too much accuracy, and also we
-     * use a precalculated table for pow10). */
+    /* First, check for infinite and nan (as we have to handle those in a different way). According to IEEE-754, those
+     * have all the exponent bits set (infinite has the fraction as zero, nan has anything else). */
 
-    if (IsInfinite(Value)) return Value < 0 ? "-Infinite" : "Infinite";
-    else if (IsNaN(Value)) return "NaN";
+    union { Float FloatValue; UInt64 IntValue; } val { .FloatValue = Value };
+    UInt64 frac = val.IntValue & 0xFFFFFFFFFFFFF, man = 0;
+    UInt32 exp = (val.IntValue >> 52) & 0x7FF;
+    Boolean sign = val.IntValue >> 63;
+    Int32 dec = 0;
+
+    if (exp == 0x7FF) return frac ? "NaN" : (sign ? "-Infinite" : "Infinite");
+    else if (exp || frac) ToDecimal(frac, exp, man, dec);
+
+    /* The value is now man * 10^dec. With FLOAT_SHORTEST as the precision, we print exactly those digits (using the
+     * exponent notation if the number is too big/small), else, we round to the precision (limited to 17 digits, more
+     * than this is a bit useless), rounding half to even, and pad with zeroes. The rounding is done on the shortest
+     * representation, instead of on the exact binary value (so 2.675 with 2 digits becomes 2.68, even though the
+     * float itself is slightly smaller than that). */
+
+    Boolean shortest = Precision == FLOAT_SHORTEST;
+    auto len = static_cast<Int32>(CountDigits(man, 10)), point = len + dec;
+    Boolean sci = point > 21 || (shortest && point < -5);
+
+    if (shortest) Precision = 0;
     else if (Precision > 17) Precision = 17;
 
-    /* Extract the sign, and do the basic buffer size checks. */
+    if (!shortest && !sci && dec + static_cast<Int32>(Precision) < 0) {
+        UInt32 cut = -(dec + static_cast<Int32>(Precision));
 
-    Int64 sign = Value < 0 ? -1 : 1;
-    Value *= sign;
+        if (cut > 17) man = 0;
+        else {
+            UInt64 quot = man / Pow10[cut], rem = man - quot * Pow10[cut], half = Pow10[cut] / 2;
+            man = quot + (rem > half || (rem == half && (quot & 1)));
+        }
 
-    if (Buffer == Null || Size < CountDigits(Value, 10) + (sign < 1 ? 1 : 0) + (Precision ? Precision + 1 : 0) + 1)
-        return {};
+        dec = -static_cast<Int32>(Precision);
+        len = CountDigits(man, 10);
+        point = len + dec;
+    }
 
-    /* Add pow10(-prec), to make sure we will, for example, print 1 instead of 0.999999... */
+    /* Convert the mantissa into the digits (using the same function as FromUInt), and calculate the final size, so that
+     * we can do the buffer size check. */
 
-    Value += Pow10Neg[Precision];
+    Char digits[21];
+    IntPtr cur = 19;
+    Int32 flen = !sci && (-dec > static_cast<Int32>(Precision)) ? -dec : static_cast<Int32>(Precision),
+          elen = point - 1 < 0 ? 1 - point : point - 1;
+    UIntPtr size = sign + (sci ? len + (len > 1) + 2 + CountDigits(elen, 10)
+                              : (point > 0 ? point : 1) + (flen > 0) + flen);
 
-    /* Start by printing the fractional part into the buffer. */
+    if (Buffer == Null || Size < size + 1) return {};
+    else if (!man) digits[cur--] = '0';
+    else ::FromUInt(digits, man, 10, cur, 0);
 
-    IntPtr cur = static_cast<IntPtr>(Size - (Precision ? Precision + 1 : 0) - 2), start = cur - 1,
-           end = sign < 0 ? 1 : 0;
+    const Char *src = &digits[cur + 1];
+    Char *out = Buffer;
 
-    if (Precision) {
-        /* Add pow10(-prec), to make sure we will print 1 instead of 0.999999... (for example). */
+    if (sign) *out++ = '-';
 
-        Float tmp = Value - static_cast<Int64>(Value);
+    if (sci) {
+        /* Exponent notation: d.ddde+XX. */
 
-        Buffer[cur++] = '.';
+        *out++ = src[0];
 
-        while (Precision--) {
-            auto dig = static_cast<Int64>(tmp *= 10);
-            Buffer[cur++] = dig + '0';
-            tmp -= dig;
+        if (len > 1) {
+            *out++ = '.';
+            for (Int32 i = 1; i < len; i++) *out++ = src[i];
         }
-    }
 
-    /* And then the integer/whole part of the float into the buffer (this uses the same process as FromInt). */
+        IntPtr ecur = static_cast<IntPtr>(CountDigits(elen, 10)) - 1;
 
-    if (!static_cast<UInt64>(Value)) Buffer[start--] = '0';
-    else ::FromUInt(Buffer, Value, 10, start, end);
-    if (sign < 0) Buffer[start--] = '-';
+        *out++ = 'e';
+        *out++ = point - 1 < 0 ? '-' : '+';
+        ::FromUInt(out, elen, 10, ecur, 0);
+        out += CountDigits(elen, 10);
+    } else {
+        /* Fixed notation: the digit at index i (of the integer and fractional parts) is src[i] if it exists, else it
+         * is a zero (either because of the exponent, or because of the padding). */
 
-    return &Buffer[start + 1];
+        if (point <= 0) *out++ = '0';
+        for (Int32 i = 0; i < point; i++) *out++ = i < len ? src[i] : '0';
+        if (flen > 0) *out++ = '.';
+        for (Int32 i = point; i < point + flen; i++) *out++ = i >= 0 && i < len ? src[i] : '0';
+    }
+
+    *out = 0;
+
+    return Buffer;
 }
 
 Void StringView::SetView(UIntPtr Start, UIntPtr End) {
@@ -273,10 +499,13 @@ UInt64 StringView::ToUInt(UIntPtr &Position, Boolean OnlyDec) const {
 }
 
 Boolean StringView::Compare(const StringView &Value) const {
-    /* Very basic compare function, it just returns if both strings are equal (same length and contents). */
+    /* Very basic compare function, it just returns if both strings are equal (same length and contents). Views of the
+     * same string (like the ones Split returns) share the buffer, so only the start of the views can be used for the
+     * shortcut (CompareMemory says that equal pointers are different). */
 
-    if (this->Value == Value.Value) return True;
-    else if (this->Value == Null || Value.Value == Null || GetViewLength() != Value.GetViewLength()) return False;
+    if (this->Value == Null || Value.Value == Null) return this->Value == Value.Value;
+    else if (GetViewLength() != Value.GetViewLength()) return False;
+    else if (this->Value + ViewStart == Value.Value + Value.ViewStart || !GetViewLength()) return True;
 
     return CompareMemory(this->Value + ViewStart, Value.Value + Value.ViewStart, GetViewLength());
 }
@@ -285,43 +514,45 @@ Boolean StringView::StartsWith(const StringView &Value) const {
     /* This is like the Compare function, but we want to limit the length to the Value's length/active view (so our
      * length/active view only needs to be at least the same as the Value's one, not exactly the same). */
 
-    if (this->Value == Value.Value) return True;
-    else if (this->Value == Null || Value.Value == Null || GetViewLength() < Value.GetViewLength()) return False;
+    if (this->Value == Null || Value.Value == Null) return this->Value == Value.Value;
+    else if (GetViewLength() < Value.GetViewLength()) return False;
+    else if (this->Value + ViewStart == Value.Value + Value.ViewStart || !Value.GetViewLength()) return True;
 
     return CompareMemory(this->Value + ViewStart, Value.Value + Value.ViewStart, Value.GetViewLength());
 }
 
-static Boolean IsDelimiter(const StringView &Delimiters, Char Value) {
-    for (Char ch : Delimiters) if (ch == Value) return True;
-    return False;
+UIntPtr StringView::Find(Char Value, UIntPtr Start) const {
+    /* Both Find functions return the position (relative to the start of the view) of the first match at or after
+     * Start, or the view length if there is none. */
+
+    if (this->Value == Null || Start >= GetViewLength()) return GetViewLength();
+    return Start + FindChar(this->Value + ViewStart + Start, Value, GetViewLength() - Start);
+}
+
+UIntPtr StringView::FindAnyOf(const StringView &Set, UIntPtr Start) const {
+    if (Value == Null || Start >= GetViewLength()) return GetViewLength();
+    return Start + CHicago::FindAnyOf(Value + ViewStart + Start, GetViewLength() - Start, Set.Value + Set.ViewStart,
+                                      Set.GetViewLength());
 }
 
 List<String> StringView::Tokenize(const StringView &Delimiters) const {
-    /* Start by checking if the delimiters string have at least one delimiter, creating the output list, and creating
-     * one "global" string pointer, we're going to initialize it to Null, and only alloc it if we need. */
+    /* Each token is found using FindAnyOf (instead of checking character by character), and created straight from a
+     * view of our string (so there is at most one allocation per token, and none for tokens that fit into the String
+     * itself). Empty tokens (two delimiters in a row) are skipped. */
 
     if (Value == Null || !Delimiters.GetViewLength()) return {};
 
-    String str;
     List<String> ret;
+    StringView tok = *this;
 
-    for (UIntPtr i = 0; i < GetViewLength(); i++) {
-        if (IsDelimiter(Delimiters, Value[i])) {
-            /* If this is one of the delimiters, we can add the string we have been creating to the list. If the string
-             * is still empty, we can just skip and go to the next character. */
+    for (UIntPtr i = 0, end; i < GetViewLength(); i = end + 1) {
+        if ((end = FindAnyOf(Delimiters, i)) == i) continue;
 
-            if (!str.Length) continue;
-            else if (ret.Add(str) != Status::Success) return {};
+        tok.ViewStart = ViewStart + i;
+        tok.ViewEnd = ViewStart + end;
 
-            str.Clear();
-
-            continue;
-        }
-
-        if (str.Append(Value[i]) != Status::Success) return {};
+        if (ret.Add(String(tok)) != Status::Success) return {};
     }
 
-    if (str.Length && ret.Add(str) != Status::Success) return {};
-
     return ret;
 }
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 18 of 2020, at 11:49 BRT
- * Last edited on July 19 of 2021 at 10:03 BRT */
+ * Last edited on October 19 of 2026 at 14:30 BRT */
 
 #pragma once
 
@@ -9,6 +9,10 @@
 
 namespace CHicago {
 
+static inline Void AtomicFence(Int32 MemOrder = __ATOMIC_SEQ_CST) {
+    __atomic_thread_fence(MemOrder);
+}
+
 template<class T> static inline T AtomicLoad(T &Pointer, Int32 MemOrder = __ATOMIC_SEQ_CST) {
     return __atomic_load_n(&Pointer, MemOrder);
 }
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 18 of 2021, at 10:33 BRT
- * Last edited on July 20 of 2021 at 15:21 BRT */
+ * Last edited on October 19 of 2026 at 18:40 BRT */
 
 #pragma once
 
@@ -25,9 +25,9 @@ typedef UInt64 UInt64x2 vector_size(16), UInt64x2U vector_size(16) aligned(1);
 
 typedef Float Floatx2 vector_size(16), Floatx2U vector_size(16) aligned(1);
 
-/* 256-bit vector types (x86/amd64 uses them for AVX ops). */
+/* 256-bit vector types (x86/amd64 uses them for AVX ops). The types themselves are always available (even with
+ * NO_256_SIMD), as functions compiled for a specific target (using the target attribute) can still use them. */
 
-#ifndef NO_256_SIMD
 typedef Char Charx32 vector_size(32), Charx32U vector_size(32) aligned(1);
 
 typedef Int8 Int8x32 vector_size(32), Int8x32U vector_size(32) aligned(1);
@@ -41,7 +41,22 @@ typedef UInt32 UInt32x8 vector_size(32), UInt32x8U vector_size(32) aligned(1);
 typedef UInt64 UInt64x4 vector_size(32), UInt64x4U vector_size(32) aligned(1);
 
 typedef Float Floatx4 vector_size(32), Floatx4U vector_size(32) aligned(1);
-#endif
+
+/* 512-bit vector types (x86/amd64 uses them for AVX-512 ops, only on functions compiled for it). */
+
+typedef Char Charx64 vector_size(64), Charx64U vector_size(64) aligned(1);
+
+typedef Int8 Int8x64 vector_size(64), Int8x64U vector_size(64) aligned(1);
+typedef Int16 Int16x32 vector_size(64), Int16x32U vector_size(64) aligned(1);
+typedef Int32 Int32x16 vector_size(64), Int32x16U vector_size(64) aligned(1);
+typedef Int64 Int64x8 vector_size(64), Int64x8U vector_size(64) aligned(1);
+
+typedef UInt8 UInt8x64 vector_size(64), UInt8x64U vector_size(64) aligned(1);
+typedef UInt16 UInt16x32 vector_size(64), UInt16x32U vector_size(64) aligned(1);
+typedef UInt32 UInt32x16 vector_size(64), UInt32x16U vector_size(64) aligned(1);
+typedef UInt64 UInt64x8 vector_size(64), UInt64x8U vector_size(64) aligned(1);
+
+typedef Float Floatx8 vector_size(64), Floatx8U vector_size(64) aligned(1);
 
 class SIMD {
 public:
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 07 of 2021, at 14:01 BRT
- * Last edited on July 20 of 2021 at 15:04 BRT */
+ * Last edited on October 20 of 2026 at 11:20 BRT */
 
 #pragma once
 
@@ -32,12 +32,12 @@ public:
      * for this we have the Format function! And yeah, we actually need to make their body here as well, because of all
      * the template<> stuff. */
 
-    template<typename... T> static inline String Format(const StringView &Format, T... Args) {
+    template<typename... T> static inline String Format(const FormatString<TypeIdentityT<T>...> &Format, T... Args) {
         /* First, let's create the string itself, we're going to use the 0-args initializer, as the Append function is
          * going to dynamically allocate the memory we need. */
 
         String str;
-        return str.Append(Format, Args...), str;
+        return str.Append<T...>(Format, Args...), str;
     }
 
     Void Clear();
@@ -54,6 +54,7 @@ public:
     }
 
     Status Append(Char);
+    Status AppendRaw(const Char*, UIntPtr);
 
     inline UIntPtr Append(Int64 Value) { Char buf[65]; return Append(StringView::FromInt(buf, Value, 65)); }
 
@@ -69,9 +70,11 @@ public:
 
     /* The Append(String, ...) also needs to be inline, for the same reason as Format (because it is template<>). */
 
-    template<typename... T> inline UIntPtr Append(const StringView &Format, T... Args) {
+    template<typename... T> inline UIntPtr Append(const FormatString<TypeIdentityT<T>...> &Format, T... Args) {
         return VariadicFormat([](UInt8 Type, UInt32 Data, Void *Context) {
             return !Type ? static_cast<String*>(Context)->Append(static_cast<Char>(Data)) == Status::Success : True;
+        }, [](const Char *Data, UIntPtr Length, Void *Context) {
+            return static_cast<String*>(Context)->AppendRaw(Data, Length) == Status::Success;
         }, static_cast<Void*>(this), Format, Args...);
     }
 
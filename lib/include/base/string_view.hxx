@@ -1,15 +1,24 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 05 of 2021, at 16:09 BRT
- * Last edited on April 18 of 2021 at 11:03 BRT */
+ * Last edited on October 20 of 2026 at 11:20 BRT */
 
 #pragma once
 
+#include <base/iterator.hxx>
 #include <ds/list.hxx>
 
+/* Precision for FromFloat (and String::Append) that means "print the shortest representation that round trips" (the
+ * default is 6 digits after the point). */
+
+#define FLOAT_SHORTEST UINTPTR_MAX
+
 namespace CHicago {
 
 class String;
+class StringSplit;
+
+UIntPtr StringLength(const Char*);
 
 class StringView {
 public:
@@ -68,7 +77,10 @@ public:
 
     Boolean Compare(const StringView&) const;
     Boolean StartsWith(const StringView&) const;
+    UIntPtr Find(Char, UIntPtr = 0) const;
+    UIntPtr FindAnyOf(const StringView&, UIntPtr = 0) const;
     List<String> Tokenize(const StringView&) const;
+    inline StringSplit Split(const StringView&) const;
 
     inline constexpr UIntPtr GetLength() const { return Length; }
     inline constexpr UIntPtr GetViewLength() const { return ViewEnd - ViewStart; }
@@ -88,6 +100,11 @@ private:
     friend class String;
 
     static inline constexpr UIntPtr CalculateLength(const Char *Value) {
+        /* At runtime we can use the SIMD version (but it's not constexpr, so we still need the loop at compile
+         * time). */
+
+        if (!__builtin_is_constant_evaluated()) return StringLength(Value);
+
         UIntPtr ret = 0;
         for (; Value[ret]; ret++) ;
         return ret;
@@ -97,4 +114,54 @@ private:
     UIntPtr Length, ViewStart, ViewEnd;
 };
 
+/* Lazy version of Tokenize: each iteration (of a ranged for loop) finds the next token, and gives a view of it (so no
+ * allocation/copy at all). Just like Tokenize, empty tokens are skipped. */
+
+class StringSplit {
+public:
+    class Iterator {
+    public:
+        using Tag = CHicago::Iterator::Forward;
+        using Val = const StringView;
+        using Ptr = const StringView*;
+        using Ref = const StringView&;
+
+        inline Iterator(const StringView &Source, const StringView &Delimiters, UIntPtr Start)
+            : Source(Source), Delimiters(Delimiters), Current(Source) { Advance(Start); }
+
+        inline Boolean operator ==(const Iterator &Other) const { return Position == Other.Position; }
+        inline Boolean operator !=(const Iterator &Other) const { return Position != Other.Position; }
+
+        inline Ref operator *() const { return Current; }
+        inline Ptr operator ->() const { return &Current; }
+        inline Iterator &operator ++() { return Advance(End + 1), *this; }
+        inline const Iterator operator ++(Int32) { Iterator it = *this; ++*this; return it; }
+    private:
+        inline Void Advance(UIntPtr Start) {
+            /* Position is where the current token starts (or the view length once we're past the last token). */
+
+            for (Position = Start; Position < Source.GetViewLength(); Position = End + 1) {
+                if ((End = Source.FindAnyOf(Delimiters, Position)) == Position) continue;
+                Current.SetView(Source.GetViewStart() + Position, Source.GetViewStart() + End);
+                return;
+            }
+
+            Position = End = Source.GetViewLength();
+        }
+
+        StringView Source, Delimiters, Current;
+        UIntPtr Position, End;
+    };
+
+    inline StringSplit(const StringView &Source, const StringView &Delimiters)
+        : Source(Source), Delimiters(Delimiters) { }
+
+    inline Iterator begin() const { return { Source, Delimiters, 0 }; }
+    inline Iterator end() const { return { Source, Delimiters, Source.GetViewLength() }; }
+private:
+    StringView Source, Delimiters;
+};
+
+inline StringSplit StringView::Split(const StringView &Delimiters) const { return { *this, Delimiters }; }
+
 }
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 15 of 2021, at 15:53 BRT
- * Last edited on March 15 of 2021 at 16:42 BRT */
+ * Last edited on October 19 of 2026 at 22:45 BRT */
 
 #pragma once
 
@@ -39,6 +39,15 @@ template<class T> using RemoveCVT = typename RemoveCV<T>::Type;
 template<class T> struct RemoveRCV { using Type = RemoveRefT<RemoveCVT<T>>; };
 template<class T> using RemoveRCVT = typename RemoveRCV<T>::Type;
 
+/* Identity (useful to stop a parameter from taking part on template argument deduction). */
+
+template<class T> struct TypeIdentity { using Type = T; };
+template<class T> using TypeIdentityT = typename TypeIdentity<T>::Type;
+
+/* And DeclVal, for getting a value of some type inside of unevaluated contexts (decltype). */
+
+template<class T> T &&DeclVal(Void) noexcept;
+
 /* Type properties. */
 
 template<class T> struct IsConst : FalseConstant {};
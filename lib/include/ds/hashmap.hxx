@@ -0,0 +1,55 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 23:55 BRT
+ * Last edited on October 19 of 2026 at 23:55 BRT */
+
+#pragma once
+
+#include <ds/hashset.hxx>
+
+namespace CHicago {
+
+/* The hash map is just a hash set of key/value pairs, where only the key is used for hashing/comparing (so anything
+ * that can be used as the key of a HashSet can be used as the key here, including looking up String keys using a
+ * StringView). */
+
+template<class K, class V> struct HashPair {
+    K Key;
+    V Value;
+};
+
+template<class K, class V> struct HashKey<HashPair<K, V>> {
+    static inline UInt64 GetHash(const HashPair<K, V> &Value) { return HashKey<K>::GetHash(Value.Key); }
+    template<class Q> static inline UInt64 GetHash(const Q &Key) { return HashKey<K>::GetHash(Key); }
+
+    static inline Boolean Compare(const HashPair<K, V> &Left, const HashPair<K, V> &Right) {
+        return HashKey<K>::Compare(Left.Key, Right.Key);
+    }
+
+    template<class Q> static inline Boolean Compare(const HashPair<K, V> &Left, const Q &Right) {
+        return HashKey<K>::Compare(Left.Key, Right);
+    }
+};
+
+template<class K, class V> class HashMap : public HashSet<HashPair<K, V>> {
+public:
+    using HashSet<HashPair<K, V>>::HashSet;
+    using HashSet<HashPair<K, V>>::Add;
+
+    inline Status Add(const K &Key, const V &Value) { return Add(HashPair<K, V> { Key, Value }); }
+    inline Status Add(K &&Key, V &&Value) { return Add(HashPair<K, V> { Move(Key), Move(Value) }); }
+
+    /* Find (on the map) gives the value, the pair can still be accessed by iterating over the map. */
+
+    template<class Q> inline V *Find(const Q &Key) {
+        HashPair<K, V> *ent = HashSet<HashPair<K, V>>::Find(Key);
+        return ent == Null ? Null : &ent->Value;
+    }
+
+    template<class Q> inline const V *Find(const Q &Key) const {
+        const HashPair<K, V> *ent = HashSet<HashPair<K, V>>::Find(Key);
+        return ent == Null ? Null : &ent->Value;
+    }
+};
+
+}
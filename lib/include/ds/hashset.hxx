@@ -0,0 +1,323 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 23:55 BRT
+ * Last edited on October 19 of 2026 at 23:55 BRT */
+
+#pragma once
+
+#include <base/simd.hxx>
+#include <base/string.hxx>
+#include <util/bitop.hxx>
+
+namespace CHicago {
+
+/* How the hash set/map know how to hash and compare a key. Integers, enums and pointers work out of the box, and so do
+ * strings (String entries can be looked up using just a StringView, so no allocation to search for something). For
+ * anything else, specialize this with a GetHash (for the entry type, and for whatever other type you want to be able to
+ * search with) and a Compare (entry vs the same types). */
+
+template<class T, class = Void> struct HashKey;
+
+template<class T> struct HashKey<T, EnableIfT<IsIntV<T> || IsEnumV<T> || IsPtrV<T>>> {
+    static inline UInt64 GetHash(T Value) {
+        /* Integers are usually sequential (and pointers are aligned), but the table uses the low 7 bits as a tag and
+         * the rest as the position, so run it through the MurmurHash3 finalizer to spread everything around. */
+
+        UInt64 ret;
+
+        if constexpr (IsPtrV<T>) ret = reinterpret_cast<UIntPtr>(Value);
+        else ret = static_cast<UInt64>(Value);
+
+        ret = (ret ^ (ret >> 33)) * 0xFF51AFD7ED558CCD;
+        ret = (ret ^ (ret >> 33)) * 0xC4CEB9FE1A85EC53;
+
+        return ret ^ (ret >> 33);
+    }
+
+    static inline Boolean Compare(T Left, T Right) { return Left == Right; }
+};
+
+template<> struct HashKey<StringView> {
+    static inline UInt64 GetHash(const StringView &Value) {
+        return Hash(Value.GetValue() + Value.GetViewStart(), Value.GetViewLength());
+    }
+
+    static inline Boolean Compare(const StringView &Left, const StringView &Right) { return Left.Compare(Right); }
+};
+
+template<> struct HashKey<String> : HashKey<StringView> { };
+
+/* Open addressing hash set, using the same layout as the Swiss tables (from abseil): Besides the slots, we have one
+ * control byte per slot, which says if the slot is empty (0x80), deleted (0xFE, a tombstone), or full (in which case
+ * it holds the low 7 bits of the hash of the entry). The slots are split into groups of 16, and a lookup only needs to
+ * load the group control bytes into a SIMD register, and compare them against the tag, to know which slots can have
+ * the entry (so we only call Compare on those, which most of the time is only one, or none at all). If the group has
+ * an empty slot, the entry can't be in any other group, else we go to the next group in the probe sequence
+ * (triangular, so that all groups get visited, as the group count is a power of two). The capacity is always zero or a
+ * power of two >= 16, and we grow (or just clean up the tombstones) when 7/8 of the slots are in use. Like List, the
+ * entries are relocated using CopyMemory, and the slots get zeroed when they become free. */
+
+template<class T> class HashSet {
+public:
+    template<class U> class Iterator {
+    public:
+        using Tag = CHicago::Iterator::Forward;
+        using Val = U;
+        using Ptr = U*;
+        using Ref = U&;
+
+        inline Iterator(const Int8 *Control, U *Slot, U *End) : Control(Control), Slot(Slot), End(End) { Skip(); }
+
+        inline Boolean operator ==(const Iterator &Other) const { return Slot == Other.Slot; }
+        inline Boolean operator !=(const Iterator &Other) const { return Slot != Other.Slot; }
+
+        inline Ref operator *() const { return *Slot; }
+        inline Ptr operator ->() const { return Slot; }
+        inline Iterator &operator ++() { Control++; Slot++; Skip(); return *this; }
+        inline const Iterator operator ++(Int32) { Iterator it = *this; ++*this; return it; }
+    private:
+        inline Void Skip() { for (; Slot != End && *Control < 0; Control++, Slot++) ; }
+
+        const Int8 *Control;
+        U *Slot, *End;
+    };
+
+    HashSet() : Control(Null), Slots(Null), Length(0), Deleted(0), Capacity(0) { }
+    HashSet(UIntPtr Size) : HashSet() { Reserve(Size); }
+    HashSet(const HashSet &Source) : HashSet() { Copy(Source); }
+    HashSet(HashSet &&Source) : HashSet() { Steal(Source); }
+
+    HashSet(const initializer_list<T> &Source) : HashSet() {
+        Reserve(Source.GetLength());
+        for (const T &data : Source) Add(data);
+    }
+
+    ~HashSet() { if (Control != Null) { Clear(); Heap::Free(Control); } }
+
+    HashSet &operator =(HashSet &&Source) {
+        if (this != &Source) {
+            if (Control != Null) {
+                Clear();
+                Heap::Free(Control);
+            }
+
+            Control = Null;
+            Slots = Null;
+            Capacity = 0;
+            Steal(Source);
+        }
+
+        return *this;
+    }
+
+    HashSet &operator =(const HashSet &Source) {
+        if (this != &Source) {
+            Clear();
+            Copy(Source);
+        }
+
+        return *this;
+    }
+
+    Status Reserve(UIntPtr Size) {
+        /* Make sure that we can hold Size entries without having to grow (taking the load factor into account). */
+
+        UIntPtr cap = 16;
+
+        for (; cap * 7 / 8 < Size; cap <<= 1) ;
+
+        return cap <= Capacity ? Status::Success : Rehash(cap);
+    }
+
+    Void Clear() {
+        /* Destroy all the entries, but keep the buffer around (the destructor is the one who frees it). */
+
+        if (!Length && !Deleted) return;
+
+        for (UIntPtr i = 0; i < Capacity; i++) if (Control[i] >= 0) Slots[i].~T();
+
+        SetMemory(Control, Empty, Capacity);
+        SetMemory(Slots, 0, Capacity * sizeof(T));
+        Length = Deleted = 0;
+    }
+
+    inline Status Add(const T &Data) { return Insert(Data); }
+    inline Status Add(T &&Data) { return Insert(Move(Data)); }
+
+    template<class Q> Status Remove(const Q &Key) {
+        UIntPtr idx = Lookup(Key);
+
+        if (idx == Capacity) return Status::DoesntExist;
+
+        Slots[idx].~T();
+        SetMemory(&Slots[idx], 0, sizeof(T));
+
+        /* If the group still has some empty slot, no lookup would ever go past it (and no insertion ever did, as it
+         * would have used that slot), so we can mark this slot as empty as well; Else we need the tombstone, so that
+         * lookups for the entries that overflowed into other groups still go past this one. */
+
+        if (MatchEmpty(idx & ~15)) Control[idx] = Empty;
+        else Control[idx] = Tombstone, Deleted++;
+
+        return Length--, Status::Success;
+    }
+
+    template<class Q> inline T *Find(const Q &Key) {
+        UIntPtr idx = Lookup(Key);
+        return idx == Capacity ? Null : &Slots[idx];
+    }
+
+    template<class Q> inline const T *Find(const Q &Key) const {
+        UIntPtr idx = Lookup(Key);
+        return idx == Capacity ? Null : &Slots[idx];
+    }
+
+    template<class Q> inline Boolean Contains(const Q &Key) const { return Lookup(Key) != Capacity; }
+
+    inline UIntPtr GetLength() const { return Length; }
+    inline UIntPtr GetCapacity() const { return Capacity; }
+
+    /* The iteration order is the slot order (so basically random, and it changes when the table grows). */
+
+    inline Iterator<T> begin() { return { Control, Slots, Slots + Capacity }; }
+    inline Iterator<const T> begin() const { return { Control, Slots, Slots + Capacity }; }
+    inline Iterator<T> end() { return { Control + Capacity, Slots + Capacity, Slots + Capacity }; }
+    inline Iterator<const T> end() const { return { Control + Capacity, Slots + Capacity, Slots + Capacity }; }
+private:
+    static constexpr Int8 Empty = -128, Tombstone = -2;
+
+    static inline UInt8 GetTag(UInt64 Hash) { return Hash & 0x7F; }
+    inline UIntPtr GetGroup(UInt64 Hash) const { return (Hash >> 7) & ((Capacity >> 4) - 1); }
+    inline UIntPtr NextGroup(UIntPtr Group, UIntPtr Step) const { return (Group + Step) & ((Capacity >> 4) - 1); }
+
+    inline Int8x16 LoadGroup(UIntPtr Index) const { return *reinterpret_cast<const Int8x16*>(&Control[Index]); }
+
+    inline UInt32 Match(UIntPtr Index, UInt8 Tag) const {
+        return SIMD::MoveMask(__builtin_bit_cast(Charx16, LoadGroup(Index) == static_cast<Int8>(Tag)));
+    }
+
+    inline UInt32 MatchEmpty(UIntPtr Index) const {
+        return SIMD::MoveMask(__builtin_bit_cast(Charx16, LoadGroup(Index) == Empty));
+    }
+
+    /* Both empty and deleted have the top bit set (and full slots don't), so the raw mask is already what we want. */
+
+    inline UInt32 MatchFree(UIntPtr Index) const {
+        return SIMD::MoveMask(__builtin_bit_cast(Charx16, LoadGroup(Index)));
+    }
+
+    template<class Q> UIntPtr Lookup(const Q &Key) const {
+        /* Returns the slot of the entry, or the capacity if there is no such entry. */
+
+        if (!Length) return Capacity;
+
+        UInt64 hash = HashKey<T>::GetHash(Key);
+        UInt8 tag = GetTag(hash);
+
+        for (UIntPtr group = GetGroup(hash), step = 1;; group = NextGroup(group, step++)) {
+            for (UInt32 match = Match(group << 4, tag); match; match &= match - 1) {
+                UIntPtr idx = (group << 4) + BitOp::ScanForward(match);
+                if (HashKey<T>::Compare(Slots[idx], Key)) return idx;
+            }
+
+            if (MatchEmpty(group << 4)) return Capacity;
+        }
+    }
+
+    UIntPtr FindFree(UInt64 Hash) const {
+        /* The load factor makes sure that there is always some free slot, so this always ends. */
+
+        for (UIntPtr group = GetGroup(Hash), step = 1;; group = NextGroup(group, step++)) {
+            UInt32 match = MatchFree(group << 4);
+            if (match) return (group << 4) + BitOp::ScanForward(match);
+        }
+    }
+
+    template<class U> Status Insert(U &&Data) {
+        /* Tombstones also count for the load factor (as they make the lookups longer), but when it's mostly them that
+         * are filling the table, we can just rehash into the same size (instead of growing). */
+
+        Status status;
+
+        if (Lookup(Data) != Capacity) return Status::AlreadyExists;
+        else if ((Length + Deleted + 1) * 8 > Capacity * 7 &&
+                 (status = Rehash(!Capacity ? 16 : ((Length + 1) * 16 > Capacity * 7 ? Capacity * 2 : Capacity)))
+                     != Status::Success) return status;
+
+        UInt64 hash = HashKey<T>::GetHash(Data);
+        UIntPtr idx = FindFree(hash);
+
+        if (Control[idx] == Tombstone) Deleted--;
+
+        Control[idx] = GetTag(hash);
+        Slots[idx] = T(Forward<U>(Data));
+
+        return Length++, Status::Success;
+    }
+
+    Status Rehash(UIntPtr Size) {
+        /* The control bytes and the slots share the same allocation (control bytes first, as Size is a multiple of 16,
+         * the slots are still aligned). Heap::Allocate already zeroes everything, so only the control bytes need to be
+         * set (to empty). */
+
+        auto buf = static_cast<UInt8*>(Heap::Allocate(Size + Size * sizeof(T)));
+        Int8 *ctrl = Control;
+        T *slots = Slots;
+        UIntPtr cap = Capacity;
+
+        if (buf == Null) return Status::OutOfMemory;
+
+        SetMemory(buf, Empty, Size);
+
+        Control = reinterpret_cast<Int8*>(buf);
+        Slots = reinterpret_cast<T*>(buf + Size);
+        Capacity = Size;
+        Deleted = 0;
+
+        for (UIntPtr i = 0; i < cap; i++) {
+            if (ctrl[i] < 0) continue;
+
+            UInt64 hash = HashKey<T>::GetHash(slots[i]);
+            UIntPtr idx = FindFree(hash);
+
+            Control[idx] = GetTag(hash);
+            CopyMemory(&Slots[idx], &slots[i], sizeof(T));
+        }
+
+        if (ctrl != Null) Heap::Free(ctrl);
+
+        return Status::Success;
+    }
+
+    Void Copy(const HashSet &Source) {
+        /* Same size and same control bytes, so every entry can go into the same slot (and no rehashing is required).
+         * On failure we're left empty (so check the length if you care about it). */
+
+        if (!Source.Length || (Capacity < Source.Capacity && Rehash(Source.Capacity) != Status::Success)) return;
+        else if (Capacity != Source.Capacity) {
+            for (const T &data : Source) Add(data);
+            return;
+        }
+
+        CopyMemory(Control, Source.Control, Capacity);
+
+        for (UIntPtr i = 0; i < Capacity; i++) if (Control[i] >= 0) Slots[i] = T(Source.Slots[i]);
+
+        Length = Source.Length;
+        Deleted = Source.Deleted;
+    }
+
+    Void Steal(HashSet &Source) {
+        Control = Exchange(Source.Control, Null);
+        Slots = Exchange(Source.Slots, Null);
+        Length = Exchange(Source.Length, 0);
+        Deleted = Exchange(Source.Deleted, 0);
+        Capacity = Exchange(Source.Capacity, 0);
+    }
+
+    Int8 *Control;
+    T *Slots;
+    UIntPtr Length, Deleted, Capacity;
+};
+
+}
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 28 of 2021, at 11:51 BRT
- * Last edited on July 10 of 2021 at 11:04 BRT */
+ * Last edited on October 19 of 2026 at 23:20 BRT */
 
 #pragma once
 
@@ -28,13 +28,17 @@ Void CopyMemory(Void*, const Void*, UIntPtr);
 Void SetMemory(Void*, UInt8, UIntPtr);
 Void MoveMemory(Void*, const Void*, UIntPtr);
 
-template<class T> class List {
+/* N is the inline capacity: the first N elements live inside the list object itself (so short lists that live on the
+ * stack never touch the heap), and only after that we move everything into a heap buffer. The default (0) is the old
+ * heap only list. As the elements are relocated using CopyMemory/MoveMemory, lists with an inline buffer (which point
+ * into themselves) shouldn't be used as the elements of another list. */
+
+template<class T, UIntPtr N = 0> class List {
 public:
-    List() : Elements(Null), Length(0), Capacity(0) { }
+    List() : Elements(GetInline()), Length(0), Capacity(N), Inline() { }
     List(UIntPtr Size) : List() { Reserve(Size); }
     List(const List &Source) : List() { Reserve(Source.Length); Add(Source); }
-    List(List &&Source) : Elements { Exchange(Source.Elements, Null) }, Length { Exchange(Source.Length, 0) },
-                          Capacity { Exchange(Source.Capacity, 0) } { }
+    List(List &&Source) : List() { Steal(Source); }
 
     List(const initializer_list<T> &Source) : List() {
         /* Let's already try to reserve the space that we need (if it fails, the Add() calls will also probably
@@ -65,12 +69,12 @@ public:
 
     List &operator =(List &&Source) {
         /* We need to overwrite the move operator, which is just the copy operator, but we have to clear/set to length=0
-         * the source list. */
+         * the source list (and get rid of whatever we had before). */
 
         if (this != &Source) {
-            Elements = Exchange(Source.Elements, Null);
-            Length = Exchange(Source.Length, 0);
-            Capacity = Exchange(Source.Capacity, 0);
+            Clear();
+            Fit();
+            Steal(Source);
         }
 
         return *this;
@@ -98,15 +102,17 @@ public:
          * function (which is our malloc function). */
 
         if (Size <= Capacity) return Status::InvalidArg;
-        else if ((buf = static_cast<T*>(Heap::Allocate(sizeof(T) * Size))) == Null) return Status::OutOfMemory;
 
         /* Don't do the same mistake I did when I first wrote this function. Remember to check if this isn't the first
-         * allocation we're doing, if that's the case, we don't need to copy the old elements nor deallocate them. */
+         * allocation we're doing, if that's the case, we don't need to copy the old elements nor deallocate them. If we
+         * already have a heap buffer, Heap::Reallocate can probably just grow it in place (and if not, it does the copy
+         * for us). */
 
-        if (Elements != Null) {
-            CopyMemory(buf, Elements, Length * sizeof(T));
-            Heap::Free(Elements);
-        }
+        if (Elements != Null && !IsInline()) {
+            if ((buf = static_cast<T*>(Heap::Reallocate(Elements, sizeof(T) * Size))) == Null)
+                return Status::OutOfMemory;
+        } else if ((buf = static_cast<T*>(Heap::Allocate(sizeof(T) * Size))) == Null) return Status::OutOfMemory;
+        else if (Elements != Null) CopyMemory(buf, Elements, Length * sizeof(T));
 
         return Elements = buf, Capacity = Size, Status::Success;
     }
@@ -117,16 +123,16 @@ public:
         /* While the Reserve function allocates a buffer that can contain at least all the items that the user
          * specified, this function deallocates any extra space, and fits the element buffer to make the
          * capacity=length. If the length is 0 (for example, we were called on the destructor), we just need to free the
-         * buffer. */
+         * buffer. Lists with an inline buffer go back into it as soon as everything fits, and shrinking the heap buffer
+         * should never need to copy anything (Heap::Reallocate shrinks in place). */
 
-        if (Elements == Null || Capacity == Length) return Status::Success;
-        else if (!Length) {
+        if (Elements == Null || Capacity == Length || IsInline()) return Status::Success;
+        else if (Length <= N) {
+            CopyMemory(Inline, Elements, Length * sizeof(T));
             Heap::Free(Elements);
-            return Elements = Null, Capacity = 0, Status::Success;
-        } else if ((buf = static_cast<T*>(Heap::Allocate(sizeof(T) * Length))) == Null) return Status::OutOfMemory;
-
-        CopyMemory(buf, Elements, Length * sizeof(T));
-        Heap::Free(Elements);
+            return ResetInline(), Status::Success;
+        } else if ((buf = static_cast<T*>(Heap::Reallocate(Elements, sizeof(T) * Length))) == Null)
+            return Status::OutOfMemory;
 
         return Elements = buf, Capacity = Length, Status::Success;
     }
@@ -222,8 +228,35 @@ public:
 
     inline const T &operator [](UIntPtr Index) const { return Elements[Index]; }
 private:
+    inline T *GetInline() { return N ? reinterpret_cast<T*>(Inline) : Null; }
+    inline Boolean IsInline() const { return N && Elements == reinterpret_cast<const T*>(Inline); }
+
+    inline Void ResetInline() {
+        /* Go back to the (empty) inline buffer; The operator [] expects everything after the length to be zeroed, so
+         * remember to clean whatever was left there. */
+
+        if (N) SetMemory(&Inline[Length * sizeof(T)], 0, (N - Length) * sizeof(T));
+        Elements = GetInline();
+        Capacity = N;
+    }
+
+    Void Steal(List &Source) {
+        /* Heap buffers can just be taken from the other list, but the inline buffer can't, so in that case we need to
+         * copy the elements (we're always empty and inline when this gets called, so they surely fit). */
+
+        if (Source.IsInline()) CopyMemory(Inline, Source.Inline, Source.Length * sizeof(T));
+        else if (Source.Elements != Null) {
+            Elements = Source.Elements;
+            Capacity = Source.Capacity;
+        }
+
+        Length = Exchange(Source.Length, 0);
+        Source.ResetInline();
+    }
+
     T *Elements;
     UIntPtr Length, Capacity;
+    alignas(T) UInt8 Inline[N * sizeof(T)];
 };
 
 }
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 04 of 2021, at 17:19 BRT
- * Last edited on July 19 of 2021, at 23:21 BRT */
+ * Last edited on October 19 of 2026, at 23:20 BRT */
 
 #pragma once
 
@@ -48,6 +48,29 @@
 #define ALLOC_BLOCK_MAGIC 0xCE8DB73F
 #endif
 
+/* Debug builds (DEBUG=true) get some extra heap checking: every allocation remembers who allocated it and gets a red
+ * zone after the requested size, freed memory is poisoned, and one out of every HEAP_DEBUG_SAMPLE_RATE allocations is
+ * also tracked for the leak report and kept in a quarantine after being freed (to catch use-after-free bugs). */
+
+#ifdef HEAP_DEBUG
+#ifndef HEAP_DEBUG_SAMPLE_RATE
+#define HEAP_DEBUG_SAMPLE_RATE 16
+#endif
+
+#define HEAP_DEBUG_RED_ZONE 16
+#define HEAP_DEBUG_QUARANTINE_SIZE 256
+#define HEAP_DEBUG_SITE_COUNT 256
+#define HEAP_DEBUG_RED_ZONE_BYTE 0xFD
+#define HEAP_DEBUG_POISON_BYTE 0xDD
+#define HEAP_DEBUG_SAMPLED 0x01
+
+#ifdef _LP64
+#define ALLOC_BLOCK_QUARANTINE_MAGIC 0xDEADD337CE8DB73F
+#else
+#define ALLOC_BLOCK_QUARANTINE_MAGIC 0xDEADB73F
+#endif
+#endif
+
 namespace CHicago {
 
 class PhysMem {
@@ -140,7 +163,13 @@ public:
 #ifdef KERNEL
     struct Block {
         UIntPtr Magic, Size;
+#ifdef HEAP_DEBUG
+        UIntPtr Site;
+        UInt32 Requested, Flags;
 #ifndef _LP64
+        UIntPtr Padding[3];
+#endif
+#elif !defined(_LP64)
         UIntPtr Padding[2];
 #endif
         union {
@@ -151,19 +180,39 @@ public:
     };
 
     static Void ReturnMemory();
+#ifdef HEAP_DEBUG
+    static Void DumpLeaks();
+#endif
 #endif
 
     static Void *Allocate(UIntPtr);
     static Void *Allocate(UIntPtr, UIntPtr);
+    static Void *Reallocate(Void*, UIntPtr);
     static Void Free(Void*);
 
 #ifdef KERNEL
 private:
+    static Block *AllocateBlock(UIntPtr);
     static Block *Split(Block*, UIntPtr, Boolean = True);
     static Block *CreateBlock(UIntPtr);
     static Block *FindFree(UIntPtr);
     static Boolean AddFree(Block*);
     static Void RemoveFree(Block*);
+    static Void Release(Block*);
+
+#ifdef HEAP_DEBUG
+    struct Site {
+        UIntPtr Address, Count, Bytes;
+    };
+
+    static no_return Void Corrupted(const Char*, Block*);
+    static Void Track(Block*, UIntPtr, UIntPtr);
+    static Void Untrack(Block*);
+
+    static Block *Quarantine[HEAP_DEBUG_QUARANTINE_SIZE];
+    static Site Sites[HEAP_DEBUG_SITE_COUNT];
+    static UIntPtr QuarantineIndex, SampleCounter;
+#endif
 
     static Block *Head, *Tail;
     static SpinLock Lock;
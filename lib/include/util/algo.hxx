@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 04 of 2021, at 11:50 BRT
- * Last edited on March 15 of 2021, at 18:06 BRT */
+ * Last edited on October 19 of 2026, at 23:55 BRT */
 
 #pragma once
 
@@ -20,25 +20,27 @@ inline constexpr UInt64 ConstHash(const Char *Data, UIntPtr Length, UInt64 Seed
      * function expects that if you're gonna call us in a constexpr, the Data is a const Char* (that is, a string, else
      * the compiler will complain and error out). */
 
-    const Char *end = Data + (Length >> 5);
+    const Char *end = Data + (Length & ~static_cast<UIntPtr>(7));
     UInt64 ret = Seed ^ (Length * 0xC6A4A7935BD1E995);
 
+    /* The bytes need to go through UInt8 before being widened (else anything >= 0x80 gets sign extended into the
+     * other bytes). The load loop gets turned into a single load+bswap by the compiler. */
+
     for (; Data < end; Data += 8) {
-        UInt64 ch = ((static_cast<UInt64>(Data[0]) << 56) | (static_cast<UInt64>(Data[1]) << 48) |
-                     (static_cast<UInt64>(Data[2]) << 40) | (static_cast<UInt64>(Data[3]) << 32) |
-                     (static_cast<UInt32>(Data[4]) << 24) | (static_cast<UInt32>(Data[5]) << 16) |
-                     (static_cast<UInt16>(Data[6]) << 8) | Data[6]) * 0xC6A4A7935BD1E995;
+        UInt64 ch = 0;
+        for (UIntPtr i = 0; i < 8; i++) ch = (ch << 8) | static_cast<UInt8>(Data[i]);
+        ch *= 0xC6A4A7935BD1E995;
         ret = (ret ^ (ch ^ (ch >> 47)) * 0xC6A4A7935BD1E995) * 0xC6A4A7935BD1E995;
     }
 
     switch (Length & 7) {
-        case 7: ret ^= static_cast<UInt64>(Data[6]) << 48;
-        case 6: ret ^= static_cast<UInt64>(Data[5]) << 40;
-        case 5: ret ^= static_cast<UInt64>(Data[4]) << 32;
-        case 4: ret ^= static_cast<UInt32>(Data[3]) << 24;
-        case 3: ret ^= static_cast<UInt32>(Data[2]) << 16;
-        case 2: ret ^= static_cast<UInt16>(Data[1]) << 8;
-        case 1: ret = (ret ^ Data[0]) * 0xC6A4A7935BD1E995;
+        case 7: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[6])) << 48;
+        case 6: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[5])) << 40;
+        case 5: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[4])) << 32;
+        case 4: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[3])) << 24;
+        case 3: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[2])) << 16;
+        case 2: ret ^= static_cast<UInt64>(static_cast<UInt8>(Data[1])) << 8;
+        case 1: ret = (ret ^ static_cast<UInt8>(Data[0])) * 0xC6A4A7935BD1E995;
     }
 
     return ret = (ret ^ (ret >> 47)) * 0xC6A4A7935BD1E995, ret ^ (ret >> 47);
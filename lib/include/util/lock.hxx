@@ -1,39 +1,168 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 17 of 2021, at 17:37 BRT
- * Last edited on July 21 of 2021 at 15:43 BRT */
+ * Last edited on October 19 of 2026 at 14:30 BRT */
 
 #pragma once
 
 #include <arch/misc.hxx>
 #include <base/atomic.hxx>
 
+#ifdef KERNEL
+#include <sys/arch.hxx>
+#endif
+
+/* Each RwLock has this many reader counters (each on its own cache line), cores share them if there are more cores
+ * than that. */
+
+#define RW_LOCK_SLOTS 16
+
 namespace CHicago {
 
+/* Ticket lock: each core that wants the lock takes a ticket (the upper 16 bits of Value), and waits until the ticket
+ * being served (the lower 16 bits) is the one it got. This makes the lock fair (FIFO), and the waiters only read the
+ * lock while spinning (the only write to the line is the release, instead of everyone trying to swap it all the time).
+ * The interrupt state is saved in a local first, and only written to the lock after we got it (else whoever was
+ * waiting would overwrite the saved state of the current owner). */
+
 class SpinLock {
 public:
     inline Boolean TryAcquire(Void) {
+        UIntPtr Context;
         ARCH_SENSITIVE_START();
 
-        if (AtomicExchange(Locked, True, __ATOMIC_ACQUIRE)) {
+        UInt32 val = AtomicLoad(Value, __ATOMIC_RELAXED);
+
+        if ((val & 0xFFFF) != (val >> 16) ||
+            !AtomicCompareExchange(Value, val, val + 0x10000, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
             ARCH_SENSITIVE_END();
             return False;
         }
 
+        Saved = Context;
+
         return True;
     }
 
     inline Void Acquire(Void) {
+        UIntPtr Context;
+        ARCH_SENSITIVE_START();
+
+        UInt16 ticket = AtomicFetchAdd(Value, 0x10000, __ATOMIC_RELAXED) >> 16;
+        while (static_cast<UInt16>(AtomicLoad(Value, __ATOMIC_ACQUIRE)) != ticket) ARCH_PAUSE();
+
+        Saved = Context;
+    }
+
+    inline Void Release(Void) {
+        /* Only the owner ever touches the lower half (which is the first UInt16, as we're little endian), so we can
+         * just do a plain (release) store to it (instead of an atomic add on the whole thing, which could carry into
+         * the next ticket). */
+
+        UIntPtr Context = Saved;
+        auto serving = reinterpret_cast<volatile UInt16*>(&Value);
+
+        AtomicStore(*serving, static_cast<UInt16>(*serving + 1), __ATOMIC_RELEASE);
+        ARCH_SENSITIVE_END();
+    }
+private:
+    UIntPtr Saved = 0;
+    volatile UInt32 Value = 0;
+};
+
+/* Reader-writer lock for read-mostly data: each reader only touches the counter of its own core (so readers on
+ * different cores never bounce any cache line between them), and the writer has to wait until every counter drops to
+ * zero. This makes the writer side quite expensive, so only use it when writes are really rare. Readers run with
+ * interrupts disabled (just like the SpinLock), but as there can be many of them at the same time, the saved
+ * interrupt state is returned to the caller instead of being saved on the lock. */
+
+class RwLock {
+public:
+    inline UIntPtr AcquireRead(Void) {
+        UIntPtr Context;
+        ARCH_SENSITIVE_START();
+
+        auto &slot = Slots[GetSlot()].Count;
+
         while (True) {
-            if (TryAcquire()) break;
-            while (AtomicLoad(Locked, __ATOMIC_RELAXED)) ARCH_PAUSE();
+            AtomicAddFetch(slot, 1);
+            if (!AtomicLoad(Writer)) break;
+            AtomicSubFetch(slot, 1, __ATOMIC_RELEASE);
+            while (AtomicLoad(Writer, __ATOMIC_RELAXED)) ARCH_PAUSE();
         }
+
+        return Context;
     }
 
-    inline Void Release(Void) { AtomicStore(Locked, False, __ATOMIC_RELEASE); ARCH_SENSITIVE_END(); }
+    inline Void ReleaseRead(UIntPtr Context) {
+        AtomicSubFetch(Slots[GetSlot()].Count, 1, __ATOMIC_RELEASE);
+        ARCH_SENSITIVE_END();
+    }
+
+    inline Void AcquireWrite(Void) {
+        /* The lock serializes the writers (and disables the interrupts for us), after that, we just need to stop any
+         * new reader, and wait for the current ones to leave. */
+
+        Lock.Acquire();
+        AtomicStore(Writer, True);
+
+        for (auto &slot : Slots) while (AtomicLoad(slot.Count)) ARCH_PAUSE();
+    }
+
+    inline Void ReleaseWrite(Void) {
+        AtomicStore(Writer, False, __ATOMIC_RELEASE);
+        Lock.Release();
+    }
+private:
+    struct aligned(64) Slot { volatile UIntPtr Count = 0; };
+
+    static inline UIntPtr GetSlot(Void) {
+#ifdef KERNEL
+        return Arch::GetCoreId() % RW_LOCK_SLOTS;
+#else
+        return 0;
+#endif
+    }
+
+    Slot Slots[RW_LOCK_SLOTS] {};
+    SpinLock Lock {};
+    volatile Boolean Writer = False;
+};
+
+/* Sequence lock for small data that is read way more often than it's written (and that is cheap to copy): readers
+ * never write anything, they just copy the data and retry if a writer was active at the same time:
+ *
+ *     do { seq = lock.ReadBegin(); copy = data; } while (lock.ReadRetry(seq));
+ *
+ * Writers are serialized by a SpinLock (so they also run with interrupts disabled, which means that a reader in an
+ * interrupt handler can never spin forever waiting for a writer on the same core). */
+
+class SeqLock {
+public:
+    inline UIntPtr ReadBegin(Void) const {
+        UIntPtr seq;
+        while ((seq = AtomicLoad(Sequence, __ATOMIC_ACQUIRE)) & 1) ARCH_PAUSE();
+        return seq;
+    }
+
+    inline Boolean ReadRetry(UIntPtr Start) const {
+        AtomicFence(__ATOMIC_ACQUIRE);
+        return AtomicLoad(Sequence, __ATOMIC_RELAXED) != Start;
+    }
+
+    inline Void AcquireWrite(Void) {
+        Lock.Acquire();
+        AtomicStore(Sequence, Sequence + 1, __ATOMIC_RELAXED);
+        AtomicFence(__ATOMIC_RELEASE);
+    }
+
+    inline Void ReleaseWrite(Void) {
+        AtomicStore(Sequence, Sequence + 1, __ATOMIC_RELEASE);
+        Lock.Release();
+    }
 private:
-    UIntPtr Context = 0;
-    volatile Boolean Locked = False;
+    SpinLock Lock {};
+    volatile UIntPtr Sequence = 0;
 };
 
 }
@@ -0,0 +1,69 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 18:40 BRT
+ * Last edited on October 20 of 2026, at 10:50 BRT */
+
+#pragma once
+
+#include <arch/misc.hxx>
+#include <base/types.hxx>
+
+namespace CHicago {
+
+/* The memory primitives have one implementation for each SIMD level that we know how to use (on x86: SSE2, AVX2 and
+ * AVX-512, plus rep movsb/stosb on processors with ERMS/FSRM), and which one gets used is decided once at boot, by
+ * Memory::Initialize (the arch-specific code checks what the processor and the OS support). Until then, everyone goes
+ * through the baseline implementations (which every processor of the arch supports). The public functions validate
+ * the arguments, so the implementations don't need to. Both CompareMemory versions are built on top of Mismatch (which
+ * returns the offset of the first byte that differs, or the length if the regions are equal). Copies/sets bigger than
+ * the non-temporal threshold (by default, derived from the size of the last level cache) bypass the caches. The string
+ * primitives (StringLength, FindChar and FindAnyOf) live here as well, as they use the same SIMD levels; the Find
+ * functions return the offset of the first match (or the length if there is none). The tests and the benchmarks for
+ * all of this are under test/ (they run on the host).
+ *
+ * There is also a second table that never touches the FPU/vector registers (GetScalarFunctions), and the public
+ * functions only use the vector one if the FPU is usable right now without trapping (ARCH_FPU_USABLE); that is, not
+ * inside interrupt handlers (unless they called Arch::BeginFpu), and not on threads whose FPU state isn't loaded. A
+ * thread that never does any real FP/SIMD work never has to save/restore its FPU state because of a CopyMemory. */
+
+struct MemoryFunctions {
+    const Char *Name;
+    Boolean Erms;
+    Void (*Copy)(Void*, const Void*, UIntPtr);
+    Void (*Set)(Void*, UInt8, UIntPtr);
+    Void (*Set32)(Void*, UInt32, UIntPtr);
+    Void (*Move)(Void*, const Void*, UIntPtr);
+    UIntPtr (*Mismatch)(const Void*, const Void*, UIntPtr);
+    UIntPtr (*StringLength)(const Char*);
+    UIntPtr (*FindAnyOf)(const Char*, UIntPtr, const Char*, UIntPtr);
+};
+
+class Memory {
+public:
+    static Void Initialize(Void);
+
+    [[nodiscard]] static const MemoryFunctions &GetFunctions(Void) { return Functions; }
+    [[nodiscard]] static const MemoryFunctions &GetScalarFunctions(Void) { return Scalar; }
+    [[nodiscard]] static const MemoryFunctions &GetActiveFunctions(Void) {
+        return ARCH_FPU_USABLE() ? Functions : Scalar;
+    }
+
+    [[nodiscard]] static UIntPtr GetNonTemporalThreshold(Void) { return NonTemporalThreshold; }
+    static Void SetNonTemporalThreshold(UIntPtr Value) { NonTemporalThreshold = Value; }
+private:
+    static MemoryFunctions Functions, Scalar;
+    static UIntPtr NonTemporalThreshold;
+};
+
+Void CopyMemory(Void*, const Void*, UIntPtr);
+Void SetMemory(Void*, UInt8, UIntPtr);
+Void SetMemory32(Void*, UInt32, UIntPtr);
+Void MoveMemory(Void*, const Void*, UIntPtr);
+Boolean CompareMemory(const Void*, const Void*, UIntPtr);
+Int32 CompareMemory(const Void*, const Void*, UIntPtr, UIntPtr&);
+
+UIntPtr StringLength(const Char*);
+UIntPtr FindChar(const Char*, Char, UIntPtr);
+UIntPtr FindAnyOf(const Char*, UIntPtr, const Char*, UIntPtr);
+
+}
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on June 26 of 2020, at 13:16 BRT
- * Last edited on July 20 of 2021 at 15:47 BRT */
+ * Last edited on October 19 of 2026 at 22:45 BRT */
 
 #pragma once
 
@@ -9,7 +9,9 @@
 #include <util/lock.hxx>
 
 /* To inherit this class you only need to implement the ->WriteInt(Char) function (AfterWrite is empty by default and
- * is not fully virtual, so you don't need to overwrite it if you don't want). */
+ * is not fully virtual, so you don't need to overwrite it if you don't want). Formatted writes pass whole spans of text
+ * to ->WriteStringInt, which by default just calls WriteInt for each character, but which can be overwritten by
+ * outputs that can do better than that. */
 
 namespace CHicago {
 
@@ -21,7 +23,7 @@ public:
     Void RestoreForeground(Void) { Lock.Acquire(); RestoreForegroundInt(); AfterWrite(); Lock.Release(); }
     Void Write(Char Data) { Lock.Acquire(); WriteInt(Data); AfterWrite(); Lock.Release(); }
 
-    template<typename... T> inline UIntPtr Write(const StringView &Format, T... Args) {
+    template<typename... T> inline UIntPtr Write(const FormatString<TypeIdentityT<T>...> &Format, T... Args) {
         /* Here we can call WriteInt one time (passing 0 as an arg) to make sure the write is even possible. Other than
          * that, it's the same processes as the String and Image formatted text output functions. */
 
@@ -35,6 +37,8 @@ public:
                                                   (Type == 2 ? out->SetForegroundInt(Data) :
                                                   (Type == 3 ? out->RestoreBackgroundInt() :
                                                                out->RestoreForegroundInt()))), True);
+        }, [](const Char *Data, UIntPtr Length, Void *Context) {
+            return static_cast<TextOutput*>(Context)->WriteStringInt(Data, Length);
         }, static_cast<Void*>(this), Format, Args...);
 
         AfterWrite();
@@ -45,6 +49,12 @@ public:
 protected:
     virtual Void AfterWrite() { }
     virtual Boolean WriteInt(Char) = 0;
+
+    virtual Boolean WriteStringInt(const Char *Data, UIntPtr Length) {
+        for (; Length--; Data++) if (!WriteInt(*Data)) return False;
+        return True;
+    }
+
     virtual Void SetBackgroundInt(UInt32) { };
     virtual Void SetForegroundInt(UInt32) { };
     virtual Void RestoreBackgroundInt(Void) { };
@@ -1,16 +1,15 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 22 of 2021, at 15:27 BRT
- * Last edited on July 17 of 2021 at 21:47 BRT */
+ * Last edited on October 19 of 2026 at 22:45 BRT */
 
 #pragma once
 
-#include <base/status.hxx>
+#include <base/string_view.hxx>
 
 namespace CHicago {
 
 class String;
-class StringView;
 
 /* The Long and ULong types are required for 64-bits support (else, we gonna get some errors to do with ambiguity). */
 
@@ -85,19 +84,234 @@ private:
     const Argument *List;
 };
 
-/* Let's already define our variadic formatting function here, there will actually be two of them, one that takes the
- * ArgumentList, and one that takes normal varargs, the second one will convert the varargs into an ArgumentList, and
- * redirect (and as it is a template<> function, it needs to be inline). */
+/* Each formatted argument has its own spec (width, precision, base and padding), the runtime parser fills it in (for
+ * every call), while format strings that are known at compile time get it filled in only once (by FormatString). The
+ * FormatValue functions then write one argument using the spec (there is one for each valid argument type, the same as
+ * the Argument constructors), into the output functions (the per character one is required, the bulk one is
+ * optional, and receives whole spans of text at once). */
 
-UIntPtr VariadicFormatInt(Boolean (*)(UInt8, UInt32, Void*), Void*, const StringView&, const ArgumentList&);
+struct FormatSpec {
+    UIntPtr Width, Precision;
+    UInt8 Base;
+    Boolean Zero, PrecisionSet;
+};
+
+struct FormatOutput {
+    Boolean (*Function)(UInt8, UInt32, Void*);
+    Boolean (*Bulk)(const Char*, UIntPtr, Void*);
+    Void *Context;
+    UIntPtr Written;
+};
+
+Boolean FormatText(FormatOutput&, const Char*, UIntPtr);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Char);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Long);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Float);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, ULong);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Int32);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Int64);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, UInt32);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, UInt64);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Status);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, Boolean);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, const Void*);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, const Char*);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, const String&);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, SetBackground);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, SetForeground);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, RestoreBackground);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, RestoreForeground);
+Boolean FormatValue(FormatOutput&, const FormatSpec&, const StringView&);
+
+/* The runtime formatting function: it takes the ArgumentList (where each argument carries its type), and parses the
+ * format string as it goes. */
+
+UIntPtr VariadicFormatInt(Boolean (*)(UInt8, UInt32, Void*), Boolean (*)(const Char*, UIntPtr, Void*), Void*,
+                          const StringView&, const ArgumentList&);
+
+/* Format strings that are string literals get parsed at compile time (by the consteval constructor), into a list of
+ * literal text spans, each followed by (at most) one argument spec; that also validates the placeholders against the
+ * argument types (indexes out of range, invalid syntax, or a base on anything other than an integer, fail to compile).
+ * Anything else (Strings, StringViews, or C strings that aren't literals) still works, but goes through the runtime
+ * parser. There is a limit on how many spans the format string can have (two for each argument plus a few extra, which
+ * is way more than what any of our format strings need, as each placeholder and each '{{' is a span). Char arrays that
+ * aren't literals can't be parsed at compile time, so those need to be passed as a StringView. */
+
+/* FormatStringError is never defined (nor constexpr): calling it while parsing makes the compilation fail, and the
+ * error message shows up in the compiler output. */
+
+Void FormatStringError(const Char*);
+
+template<class... T> class FormatString {
+    struct Segment {
+        UInt16 Start = 0, Length = 0;
+        UInt8 Index = 0, Base = 10, Width = 0, Precision = 0;
+        Boolean HasSpec = False, Zero = False, PrecisionSet = False;
+    };
+
+    static constexpr UIntPtr MaxSegments = sizeof...(T) * 2 + 8;
+public:
+    template<UIntPtr N> consteval FormatString(const Char (&Value)[N])
+            : Source(Value), Segments(), Count(0), Compiled(True) { Parse(Value, N - 1); }
+
+    template<class S, class = EnableIfT<!IsArrV<S>>, class = decltype(StringView(DeclVal<const S&>()))>
+    FormatString(const S &Value)
+            : Source(Value), Segments(), Count(0), Compiled(False) { }
+
+    inline const StringView &GetSource(Void) const { return Source; }
+
+    template<class... A> inline UIntPtr Write(FormatOutput &Out, const A&... Args) const {
+        /* This should only be called by VariadicFormat, and only for compiled format strings; the argument index
+         * dispatch (in FormatAt) gets resolved into direct calls for each argument type. */
+
+        const Char *src = Source.GetValue();
+
+        for (UIntPtr i = 0; i < Count; i++) {
+            const Segment &seg = Segments[i];
+            if (!FormatText(Out, src + seg.Start, seg.Length)) break;
+            else if (!seg.HasSpec) continue;
+
+            FormatSpec spec { seg.Width, seg.Precision, seg.Base, seg.Zero, seg.PrecisionSet };
+            if (!FormatAt(Out, spec, seg.Index, Args...)) break;
+        }
+
+        return Out.Written;
+    }
+
+    inline Boolean IsCompiled(Void) const { return Compiled; }
+private:
+    template<class A, class... R> static inline Boolean FormatAt(FormatOutput &Out, const FormatSpec &Spec,
+                                                                 UIntPtr Index, const A &Arg, const R&... Rest) {
+        if (!Index) return FormatValue(Out, Spec, Arg);
+        else if constexpr (sizeof...(R) > 0) return FormatAt(Out, Spec, Index - 1, Rest...);
+        else return False;
+    }
+
+    static inline Boolean FormatAt(FormatOutput&, const FormatSpec&, UIntPtr) { return False; }
+
+    template<class A> static consteval Boolean IsInteger(Void) {
+        using U = RemoveCVT<A>;
+        return (IsIntV<U> && !IsSameV<U, Char> && !IsSameV<U, Boolean>) ||
+               (IsPtrV<U> && !IsSameV<U, const Char*> && !IsSameV<U, Char*>);
+    }
+
+    static consteval UIntPtr ParseNumber(const Char *Value, UIntPtr Length, UIntPtr &Position) {
+        UIntPtr ret = 0;
+
+        if (Position >= Length || Value[Position] < '0' || Value[Position] > '9')
+            FormatStringError("expected a number in the format string");
+
+        for (; Position < Length && Value[Position] >= '0' && Value[Position] <= '9'; Position++)
+            ret = ret * 10 + Value[Position] - '0';
+
+        return ret;
+    }
+
+    consteval Void AddSegment(UIntPtr Start, UIntPtr End) {
+        if (Count >= MaxSegments) FormatStringError("too many placeholders/escapes in the format string");
+        else if (End > 0xFFFF) FormatStringError("format string too long");
+
+        Segments[Count].Start = Start;
+        Segments[Count++].Length = End - Start;
+    }
+
+    consteval Void Parse(const Char *Value, UIntPtr Length) {
+        /* Same syntax as the runtime parser ('{index:width.precision:base}', everything optional, with a leading zero
+         * on the width meaning zero padding, and '*' on the width/precision meaning "as many hex digits as a pointer
+         * has"). The stars are resolved here already, as they depend on the type. */
+
+        constexpr Boolean ints[] = { IsInteger<T>()..., False }, floats[] = { IsFloatV<RemoveCVT<T>>..., False };
+        UIntPtr pos = 0, start = 0, last = 0;
+
+        while (pos < Length) {
+            if (Value[pos] != '{') {
+                pos++;
+                continue;
+            }
+
+            AddSegment(start, pos);
+
+            if (pos + 1 < Length && Value[pos + 1] == '{') {
+                Segments[Count - 1].Length++;
+                start = pos += 2;
+                continue;
+            }
+
+            Segment &seg = Segments[Count - 1];
+            UIntPtr idx, width = 0, prec = 0, base = 10;
+            Boolean wset = False, pset = False;
+
+            if (++pos < Length && Value[pos] != '}' && Value[pos] != ':') idx = ParseNumber(Value, Length, pos);
+            else idx = last++;
+
+            if (idx >= sizeof...(T)) FormatStringError("format string argument index out of range");
+
+            if (pos < Length && Value[pos] == ':') {
+                if (++pos < Length && Value[pos] == '0') seg.Zero = True, pos++;
+
+                if (pos < Length && Value[pos] == '*') wset = True, pos++;
+                else if (pos < Length && Value[pos] != '.' && Value[pos] != ':' && Value[pos] != '}')
+                    width = ParseNumber(Value, Length, pos);
+
+                if (pos < Length && Value[pos] == '.') {
+                    if (++pos < Length && Value[pos] == '*') pset = True, pos++;
+                    else prec = ParseNumber(Value, Length, pos);
+                    seg.PrecisionSet = True;
+                }
+
+                if (pos < Length && Value[pos] == ':') base = ParseNumber(Value, Length, ++pos);
+            }
+
+            if (pos >= Length || Value[pos++] != '}') FormatStringError("unterminated placeholder in format string");
+            else if (base < 2 || base > 36) FormatStringError("invalid base in format string");
+            else if (base != 10 && !ints[idx]) FormatStringError("format string base used on a non-integer argument");
+
+            if (wset) width = sizeof(UIntPtr) * 2;
+            if (pset) prec = floats[idx] ? 16 : sizeof(UIntPtr) * 2;
+            if (width > 0xFF || prec > 0xFF) FormatStringError("width/precision too big in format string");
+
+            seg.HasSpec = True;
+            seg.Index = idx;
+            seg.Base = base;
+            seg.Width = width;
+            seg.Precision = prec;
+            start = pos;
+        }
+
+        if (start < Length) AddSegment(start, Length);
+    }
+
+    StringView Source;
+    Segment Segments[MaxSegments];
+    UIntPtr Count;
+    Boolean Compiled;
+};
+
+/* And the actual formatting function, which just redirects into the right implementation (and as it is a template<>
+ * function, it needs to be inline). The output can also pass a bulk write function. */
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-value"
 
+template<typename... T> static inline UIntPtr VariadicFormat(Boolean (*Function)(UInt8, UInt32, Void*),
+                                                             Boolean (*Bulk)(const Char*, UIntPtr, Void*),
+                                                             Void *Context,
+                                                             const FormatString<TypeIdentityT<T>...> &Format,
+                                                             T... Args) {
+    if (Function == Null) return 0;
+    else if (!Format.IsCompiled()) {
+        Argument list[] = { Args... };
+        return VariadicFormatInt(Function, Bulk, Context, Format.GetSource(), ArgumentList(sizeof...(Args), list));
+    }
+
+    FormatOutput out { Function, Bulk, Context, 0 };
+    return Format.Write(out, Args...);
+}
+
 template<typename... T> static inline UIntPtr VariadicFormat(Boolean (*Function)(UInt8, UInt32, Void*), Void *Context,
-                                            const StringView &Format, T... Args) {
-    Argument list[] = { Args... };
-    return VariadicFormatInt(Function, Context, Format, ArgumentList(sizeof...(Args), list));
+                                                             const FormatString<TypeIdentityT<T>...> &Format,
+                                                             T... Args) {
+    return VariadicFormat<T...>(Function, Null, Context, Format, Args...);
 }
 
 #pragma GCC diagnostic pop
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 07 of 2021, at 17:37 BRT
- * Last edited on July 20 of 2021 at 15:26 BRT */
+ * Last edited on October 19 of 2026 at 22:45 BRT */
 
 #pragma once
 
@@ -98,8 +98,8 @@ public:
     Void DrawRectangle(UInt16, UInt16, UInt16, UInt16, UInt32, Boolean = False);
     Boolean DrawCharacter(UInt16, UInt16, Char, UInt32);
 
-    template<class... T> inline UIntPtr DrawString(UInt16 X, UInt16 Y, UInt32 Color, const StringView &Format,
-                                                   T... Args) {
+    template<class... T> inline UIntPtr DrawString(UInt16 X, UInt16 Y, UInt32 Color,
+                                                   const FormatString<TypeIdentityT<T>...> &Format, T... Args) {
         if (Buffer == Null || X >= Width || Y >= Height) return 0;
 
         /* As we can't use a lambda that captures local variables as a function pointer, we need to save and pass the
@@ -126,7 +126,8 @@ public:
         }, ctx, Format, Args...);
     }
 
-    template<class... T> static inline Void GetStringSize(UIntPtr &Width, UIntPtr &Height, const StringView &Format,
+    template<class... T> static inline Void GetStringSize(UIntPtr &Width, UIntPtr &Height,
+                                                          const FormatString<TypeIdentityT<T>...> &Format,
                                                           T... Args) {
         UIntPtr ctx[4] { 0, 0, 0 }; VariadicFormat([](UInt8 Type, UInt32 Data, Void *Context) {
             auto ctx = static_cast<UIntPtr*>(Context);
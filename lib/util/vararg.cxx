@@ -1,50 +1,200 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 07 of 2021, at 15:57 BRT
- * Last edited on July 17 of 2021 at 21:48 BRT */
+ * Last edited on October 20 of 2026 at 11:20 BRT */
 
 #include <base/string.hxx>
+#include <util/memory.hxx>
 
 using namespace CHicago;
 
 /* Some macros to make our life a bit easier. */
 
-#define WRITE_CHAR(c) if (!Function(0, c, Context)) return written; written++
-#define WRITE_STRING(str, sz) if (!WriteString(str, sz, Function, Context)) return written; written += sz
-#define PAD(cnt, c) do { for (UIntPtr i = 0; i < (cnt); i++) WRITE_CHAR(c); } while (False)
+#define WRITE_CHAR(c) if (!Out.Function(0, c, Out.Context)) return False; Out.Written++
+#define WRITE_STRING(str, sz) if (!FormatText(Out, str, sz)) return False
+#define PAD(cnt, c) if (!Pad(Out, cnt, c)) return False
 
 namespace CHicago {
 
 static Boolean IsDigit(Char Value) { return Value >= '0' && Value <= '9'; }
 
-static const Char *FindFirst(const Char *Data, Char Value, UIntPtr Length) {
-    /* Just find the first occurrence of the character Value in the buffer Data. This can be extended to not only
-     * strings (if we just change const Char* into const Void*). */
+static Boolean Pad(FormatOutput &Out, UIntPtr Count, Char Value) {
+    /* Padding is always either spaces or zeroes, so for bulk outputs we can just write it in chunks out of a constant
+     * buffer. */
 
-    for (; Length--; Data++) if (*Data == Value) return Data;
-    return Null;
-}
+    static const Char spaces[] = "                                ", zeroes[] = "00000000000000000000000000000000";
+
+    if (Out.Bulk == Null) {
+        for (; Count; Count--, Out.Written++) if (!Out.Function(0, Value, Out.Context)) return False;
+        return True;
+    }
 
-static Boolean WriteString(const Char *Data, UIntPtr DataSize, Boolean (*Function)(UInt8, UInt32, Void*),
-                           Void *Context) {
-    while (*Data) {
-        if (!(DataSize--)) break;
-        else if (!Function(0, *Data++, Context)) return False;
+    for (UIntPtr size; Count; Count -= size) {
+        size = Count > sizeof(spaces) - 1 ? sizeof(spaces) - 1 : Count;
+        if (!FormatText(Out, Value == '0' ? zeroes : spaces, size)) return False;
     }
 
     return True;
 }
 
-static Boolean IsNormal(Float Value) {
+static Boolean IsFinite(Float Value) {
     union { Float FloatValue; UInt64 IntValue; } val { .FloatValue = Value };
-    return !(val.IntValue & 0xFFFFFFFFFFFFF);
+    return (val.IntValue & 0x7FF0000000000000) != 0x7FF0000000000000;
+}
+
+Boolean FormatText(FormatOutput &Out, const Char *Data, UIntPtr DataSize) {
+    /* If the output gave us a bulk write function, it gets the whole span at once (instead of one indirect call per
+     * character). Either way, we stop at the first NUL (if there is one inside of the span). */
+
+    if (!DataSize) return True;
+    else if (Out.Bulk != Null) {
+        if (!(DataSize = FindChar(Data, 0, DataSize))) return True;
+        else if (!Out.Bulk(Data, DataSize, Out.Context)) return False;
+        Out.Written += DataSize;
+        return True;
+    }
+
+    for (; DataSize-- && *Data; Out.Written++) if (!Out.Function(0, *Data++, Out.Context)) return False;
+
+    return True;
+}
+
+static Boolean FormatInteger(FormatOutput &Out, const FormatSpec &Spec, UInt64 Value, Boolean Negative) {
+    /* Integers. We have a little bit of work to do: Use FromUInt to convert the number (the caller already saved the
+     * sign and made it positive) into a string, do the padding, write the sign (if necessary), and finally write the
+     * number. */
+
+    Char buf[65];
+    StringView str = StringView::FromUInt(buf, Value, 65, Spec.Base);
+    UIntPtr len = str.GetLength(), flen = len + Negative,
+            spaces = !Spec.Zero && Spec.Width > flen && Spec.Width > Spec.Precision ?
+                     Spec.Width - Spec.Precision - (Spec.Precision ? 0 : flen) : 0,
+            pad = Spec.Zero ? (Spec.Width > Spec.Precision ? Spec.Width : Spec.Precision) : Spec.Precision;
+
+    pad = pad > flen ? pad - flen : 0;
+
+    PAD(spaces, ' ');
+
+    if (Negative) { WRITE_CHAR('-'); }
+
+    PAD(pad, '0');
+    WRITE_STRING(str.GetValue(), len);
+
+    return True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Int64 Value) {
+    return FormatInteger(Out, Spec, Value < 0 ? -static_cast<UInt64>(Value) : Value, Value < 0);
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Long Value) {
+    return FormatValue(Out, Spec, Int64(Value));
 }
 
-UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Context, const StringView &Format,
-                          const ArgumentList &Arguments) {
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Int32 Value) {
+    return FormatValue(Out, Spec, Int64(Value));
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, UInt64 Value) {
+    return FormatInteger(Out, Spec, Value, False);
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, ULong Value) {
+    return FormatInteger(Out, Spec, Value, False);
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, UInt32 Value) {
+    return FormatInteger(Out, Spec, Value, False);
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, const Void *Value) {
+    return FormatInteger(Out, Spec, reinterpret_cast<UIntPtr>(Value), False);
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Float Value) {
+    /* For floats/doubles, again, it's pretty much the same, but the precision is handled differently (without one, we
+     * use 6 digits), and FromFloat already handles the sign (which needs to go before any zero padding). */
+
+    Char buf[65];
+    StringView str = StringView::FromFloat(buf, Value, 65, Spec.PrecisionSet ? Spec.Precision : 6);
+    UIntPtr len = str.GetLength(), pad = Spec.Width > len ? Spec.Width - len : 0;
+    Boolean zpad = Spec.Zero && IsFinite(Value), skip = zpad && len && str[0] == '-';
+
+    if (!zpad) {
+        PAD(pad, ' ');
+    } else if (skip) {
+        WRITE_CHAR('-');
+    }
+
+    if (zpad) PAD(pad, '0');
+    WRITE_STRING(str.GetValue() + skip, len - skip);
+
+    return True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, const StringView &Value) {
+    /* And for strings, we just need to remember the padding (which will be spaces), and limiting the length (using the
+     * precision). */
+
+    UIntPtr len = Value.GetViewLength();
+    if (Spec.PrecisionSet && len > Spec.Precision) len = Spec.Precision;
+
+    PAD(Spec.Width > len ? Spec.Width - len : 0, ' ');
+    WRITE_STRING(Value.GetValue() + Value.GetViewStart(), len);
+
+    return True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, const Char *Value) {
+    return FormatValue(Out, Spec, StringView(Value));
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, const String &Value) {
+    return FormatValue(Out, Spec, StringView(Value));
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Boolean Value) {
+    return FormatValue(Out, Spec, StringView(Value ? "True" : "False"));
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Status Value) {
+    return FormatValue(Out, Spec, StringView::FromStatus(Value));
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec &Spec, Char Value) {
+    /* For characters, well, we just need to handle the padding. */
+
+    PAD(Spec.Width > 1 ? Spec.Width - 1 : 0, ' ');
+    WRITE_CHAR(Value);
+
+    return True;
+}
+
+/* SetBackground/Foreground (and RestoreBackground/Foreground) are kind of special, instead of using type 0 (write
+ * character/string), they use type 1/2/3/4, which means that we don't even have any padding to do here. */
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec&, SetBackground Value) {
+    return Out.Function(1, Value.Color, Out.Context), True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec&, SetForeground Value) {
+    return Out.Function(2, Value.Color, Out.Context), True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec&, RestoreBackground) {
+    return Out.Function(3, 0, Out.Context), True;
+}
+
+Boolean FormatValue(FormatOutput &Out, const FormatSpec&, RestoreForeground) {
+    return Out.Function(4, 0, Out.Context), True;
+}
+
+UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Boolean (*Bulk)(const Char*, UIntPtr, Void*),
+                          Void *Context, const StringView &Format, const ArgumentList &Arguments) {
     if (Function == Null) return 0;
 
-    UIntPtr last = 0, pos = 0, written = 0;
+    UIntPtr last = 0, pos = 0;
+    FormatOutput out { Function, Bulk, Context, 0 };
 
     /* Let's parse the format string, most of it will probably just be raw text. */
 
@@ -54,15 +204,10 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
          * the same time). */
 
         if (Format[pos] != '{') {
-            const Char *end = FindFirst(Format.GetValue() + Format.GetViewStart() + pos, '{',
-                                        Format.GetViewLength() - pos);
-            UIntPtr size = end != Null ? end - Format.GetValue() - Format.GetViewStart() - pos :
-                                         Format.GetViewLength() - pos;
-
-            if (!WriteString(Format.GetValue() + Format.GetViewStart() + pos, size, Function, Context)) break;
+            UIntPtr size = FindChar(Format.GetValue() + Format.GetViewStart() + pos, '{', Format.GetViewLength() - pos);
+            if (!FormatText(out, Format.GetValue() + Format.GetViewStart() + pos, size)) break;
 
             pos += size;
-            written += size;
 
             continue;
         }
@@ -70,20 +215,20 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
         /* Now it is parsing time, we except something on the format '{pos:width.prec:base}', where everything is
          * optional (and the type is parsed automatically using the argument list). It has to be on that format/order,
          * if it isn't, we're going to error out. Also, some things are invalid in a few types (like the base on floats,
-         * or the precision in characters), but in those cases we're just going to ignore said invalid data. */
+         * or the precision in characters), but in those cases we're just going to ignore said invalid data. Format
+         * strings known at compile time don't come through here (FormatString already parsed them). */
 
         pos++;
 
         Int8 pset = 0;
-        UInt8 base = 10;
-        Char buf[65] = { 0 };
-        UIntPtr idx = 0, width = 0, prec = 0;
-        Boolean zero = False, iset = False, wset = False;
+        UIntPtr idx = 0;
+        Boolean iset = False, wset = False;
+        FormatSpec spec { 0, 0, 10, False, False };
 
         if (Format[pos] == '{') {
             /* One extra valid format: '{{', it means that we should just print '{'. */
 
-            WRITE_CHAR('{');
+            if (!FormatText(out, "{", 1)) break;
             pos++;
 
             continue;
@@ -93,14 +238,14 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
             /* Expect a number, which will tell us the position of the argument on the arg list, if it is not here,
              * error out. */
 
-            if (!IsDigit(Format[pos])) return written;
+            if (!IsDigit(Format[pos])) break;
 
             idx = Format.ToUInt(pos, True);
             iset = True;
 
             /* Remember to make sure the index is not crazy (as we DO have the var arg list size). */
 
-            if (idx >= Arguments.GetCount()) return written;
+            if (idx >= Arguments.GetCount()) break;
         }
 
         if (Format[pos] == ':') {
@@ -109,7 +254,7 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
              * of spaces (and it is NOT part of the main width/prec that we're going to parse). */
 
             if (Format[++pos] == '0') {
-                zero = True;
+                spec.Zero = True;
                 pos++;
             }
 
@@ -118,16 +263,16 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
             if (Format[pos] != '.' && Format[pos] != ':' && Format[pos] != '}') {
                 if (Format[pos] == '*') wset = True, pos++;
                 else {
-                    if (!IsDigit(Format[pos])) return written;
-                    width = Format.ToUInt(pos, True);
+                    if (!IsDigit(Format[pos])) break;
+                    spec.Width = Format.ToUInt(pos, True);
                 }
             }
 
-            if (Format[pos] != '.' && Format[pos] != ':' && Format[pos] != '}') return written;
-            else if (Format[pos] == '.' && Format[pos + 1] == '*') prec = sizeof(UIntPtr) * 2, pset = 2, pos += 2;
+            if (Format[pos] != '.' && Format[pos] != ':' && Format[pos] != '}') break;
+            else if (Format[pos] == '.' && Format[pos + 1] == '*') pset = 2, pos += 2;
             else if (Format[pos] == '.') {
-                if (!IsDigit(Format[++pos])) return written;
-                prec = Format.ToUInt(pos, True);
+                if (!IsDigit(Format[++pos])) break;
+                spec.Precision = Format.ToUInt(pos, True);
                 pset = 1;
             }
         }
@@ -135,129 +280,54 @@ UIntPtr VariadicFormatInt(Boolean (*Function)(UInt8, UInt32, Void*), Void *Conte
         if (Format[pos] == ':') {
             /* Last possible format specifier, the base, just parse it as an integer. */
 
-            if (!IsDigit(Format[++pos])) return written;
-            base = Format.ToUInt(pos, True);
+            if (!IsDigit(Format[++pos])) break;
+            spec.Base = Format.ToUInt(pos, True);
         }
 
-        if (Format[pos++] != '}') return written;
+        if (Format[pos++] != '}') break;
 
         /* Now, let's go into actually printing: We can what kind of data we should print using the argument type, so
          * it is not hard. But before that, we have to make sure to set the index if it hasn't been set yet. */
 
         if (!iset) {
             idx = last++;
-            if (idx >= Arguments.GetCount()) return written;
+            if (idx >= Arguments.GetCount()) break;
         }
 
         ArgumentType type = Arguments[idx].GetType();
         ArgumentValue val = Arguments[idx].GetValue();
+        Boolean res = True;
 
-        switch (type) {
-        case ArgumentType::Long: case ArgumentType::Int32: case ArgumentType::Int64: {
-            /* Signed integers. We have a little bit of work to do: Use FromUInt to convert the number (after saving the
-             * sign and making it positive) into a string, do the padding, write the sign (if necessary), and finally
-             * write the number. */
-
-            if (wset) width = sizeof(UIntPtr) * 2;
-            if (pset == 2) prec = sizeof(UIntPtr) * 2;
-
-            Int64 ival = type == ArgumentType::Long ? val.LongValue : (type == ArgumentType::Int32 ? val.Int32Value
-                                                                                                   : val.Int64Value);
-            StringView str = StringView::FromUInt(buf, ival < 0 ? -ival : ival, 65, base);
-            UIntPtr len = str.GetLength(), flen = len + (ival < 0),
-                    spaces = !zero && width > flen && width > prec ? width - prec - (prec ? 0 : flen) : 0,
-                    pad = zero ? (width > prec ? width : prec) : prec;
-
-            pad = pad > flen ? pad - flen : 0;
-
-            PAD(spaces, ' ');
-
-            if (ival < 0) { WRITE_CHAR('-'); }
-
-            PAD(pad, '0');
-            WRITE_STRING(str.GetValue(), len);
-
-            break;
-        }
-        case ArgumentType::ULong: case ArgumentType::UInt32: case ArgumentType::UInt64: case ArgumentType::Pointer: {
-            /* For unsigned integers, what we gonna do is very similar to what we did above, but there is no need to
-             * handle the sign. */
-
-            if (wset) width = sizeof(UIntPtr) * 2;
-            if (pset == 2) prec = sizeof(UIntPtr) * 2;
-
-            UInt64 ival = type == ArgumentType::ULong ? val.ULongValue :
-                          (type == ArgumentType::UInt32 ? val.UInt32Value :
-                          (type == ArgumentType::UInt64 ? val.UInt64Value :
-                          reinterpret_cast<UIntPtr>(val.PointerValue)));
-            StringView str = StringView::FromUInt(buf, ival, 65, base);
-            UIntPtr len = str.GetLength(),
-                    spaces = !zero && width > len && width > prec ? width - prec - (prec ? 0 : len) : 0,
-                    pad = zero ? (width > prec ? width : prec) : prec;
+        if (wset) spec.Width = sizeof(UIntPtr) * 2;
+        if (pset == 2) spec.Precision = type == ArgumentType::Float ? 16 : sizeof(UIntPtr) * 2;
 
-            pad = pad > len ? pad - len : 0;
+        spec.PrecisionSet = pset;
 
-            PAD(spaces, ' ');
-            PAD(pad, '0');
-            WRITE_STRING(str.GetValue(), len);
-
-            break;
+        switch (type) {
+        case ArgumentType::Float: res = FormatValue(out, spec, val.FloatValue); break;
+        case ArgumentType::Long: res = FormatValue(out, spec, val.LongValue); break;
+        case ArgumentType::Int32: res = FormatValue(out, spec, val.Int32Value); break;
+        case ArgumentType::Int64: res = FormatValue(out, spec, val.Int64Value); break;
+        case ArgumentType::ULong: res = FormatValue(out, spec, val.ULongValue); break;
+        case ArgumentType::UInt32: res = FormatValue(out, spec, val.UInt32Value); break;
+        case ArgumentType::UInt64: res = FormatValue(out, spec, val.UInt64Value); break;
+        case ArgumentType::Char: res = FormatValue(out, spec, val.CharValue); break;
+        case ArgumentType::Boolean: res = FormatValue(out, spec, val.BooleanValue); break;
+        case ArgumentType::Pointer: res = FormatValue(out, spec, val.PointerValue); break;
+        case ArgumentType::CString: res = FormatValue(out, spec, val.CStringValue); break;
+        case ArgumentType::Status: res = FormatValue(out, spec, val.StatusValue); break;
+        case ArgumentType::CHString: res = FormatValue(out, spec, *val.CHStringValue); break;
+        case ArgumentType::CHStringView: res = FormatValue(out, spec, *val.CHStringViewValue); break;
+        case ArgumentType::SetBackground: res = FormatValue(out, spec, SetBackground { val.UInt32Value }); break;
+        case ArgumentType::SetForeground: res = FormatValue(out, spec, SetForeground { val.UInt32Value }); break;
+        case ArgumentType::RestoreBackground: res = FormatValue(out, spec, RestoreBackground {}); break;
+        case ArgumentType::RestoreForeground: res = FormatValue(out, spec, RestoreForeground {}); break;
         }
-        case ArgumentType::Float: {
-            /* For floats/doubles, again, it's pretty much the same, but the precision is handled differently, and we
-             * use FromFloat. */
-
-            if (pset == 2) prec = 16;
 
-            Float fval = val.FloatValue;
-            Boolean neg = IsNormal(fval) && fval < 0;
-            StringView str = StringView::FromFloat(buf, neg ? -fval : fval, 65, pset ? prec : 6);
-            UIntPtr len = str.GetLength(), flen = len + neg, pad = width > flen ? width - flen : 0;
-
-            if (neg) { WRITE_CHAR('-'); }
-            PAD(pad, IsNormal(fval) ? '0' : ' ');
-            WRITE_STRING(str.GetValue(), len);
-
-            break;
-        }
-        case ArgumentType::Boolean: case ArgumentType::Status: case ArgumentType::CString:
-        case ArgumentType::CHString: case ArgumentType::CHStringView: {
-            /* And for strings, we just need to remember the padding (which will be spaces), and limiting the length
-             * (using the precision). */
-
-            const StringView &str = type == ArgumentType::CString ? val.CStringValue :
-                                    (type == ArgumentType::CHString ? StringView(*val.CHStringValue) :
-                                    (type == ArgumentType::CHStringView ? *val.CHStringViewValue :
-                                    (type == ArgumentType::Boolean ? (val.BooleanValue ? "True" : "False") :
-                                                                     StringView::FromStatus(val.StatusValue))));
-            UIntPtr len = str.GetViewLength();
-            if (pset && len > prec) len = prec;
-
-            PAD(width > len ? width - len : 0, ' ');
-            WRITE_STRING(str.GetValue() + str.GetViewStart(), len);
-
-            break;
-        }
-        case ArgumentType::Char:
-            /* Finally, for characters, well, we just need to handle the padding. */
-
-            PAD(width > 1 ? width - 1 : 0, ' ');
-            WRITE_CHAR(val.CharValue);
-
-            break;
-        case ArgumentType::SetBackground: case ArgumentType::SetForeground: case ArgumentType::RestoreBackground:
-        case ArgumentType::RestoreForeground:
-            /* SetBackground/Foreground (and RestoreBackground/Foreground) are kind of special, instead of using type 0
-             * (write character/string), they use type 1/2/3/4, which means that we don't even have any padding to do
-             * here. */
-            Function(type == ArgumentType::SetBackground ? 1 :
-                     (type == ArgumentType::SetForeground ? 2 : (type == ArgumentType::RestoreBackground ? 3 : 4)),
-                     val.UInt32Value, Context);
-            break;
-        }
+        if (!res) break;
     }
 
-    return written;
+    return out.Written;
 }
 
 }
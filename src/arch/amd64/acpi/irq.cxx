@@ -0,0 +1 @@
+../../x86/acpi/irq.cxx
\ No newline at end of file
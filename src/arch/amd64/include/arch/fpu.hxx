@@ -0,0 +1 @@
+../../../x86/include/arch/fpu.hxx
\ No newline at end of file
@@ -0,0 +1 @@
+../../x86/sys/call.cxx
\ No newline at end of file
@@ -0,0 +1 @@
+../../x86/sys/fpu.cxx
\ No newline at end of file
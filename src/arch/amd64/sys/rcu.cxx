@@ -0,0 +1 @@
+../../x86/sys/rcu.cxx
\ No newline at end of file
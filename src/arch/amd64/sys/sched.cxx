@@ -0,0 +1 @@
+../../x86/sys/sched.cxx
\ No newline at end of file
@@ -0,0 +1 @@
+../../x86/sys/work.cxx
\ No newline at end of file
@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 21 of 2021, at 09:57 BRT
- * Last edited on July 21 of 2021, at 20:05 BRT */
+ * Last edited on October 19 of 2026, at 16:20 BRT */
 
 #include <arch/acpi.hxx>
 #include <arch/port.hxx>
@@ -9,10 +9,29 @@
 
 using namespace CHicago;
 
-Boolean Apic::Initialized = False;
+Boolean Apic::Initialized = False, Apic::TscDeadline = False, Apic::TscInvariant = False;
+UInt64 Apic::TscFrequency = 0, Apic::TimerFrequency = 0;
 UIntPtr Apic::LApicAddress = 0;
 List<IoApic> Apic::IoApics {};
 
+extern TimerWheel BspWheel;
+
+static UInt64 GetCycles(UInt64 Nanoseconds, UInt64 Frequency) {
+    /* Split the multiplication (same as on the HPET code), so that long delays don't overflow. */
+
+    return (Nanoseconds / 1000000000) * Frequency + (Nanoseconds % 1000000000) * Frequency / 1000000000;
+}
+
+static UInt64 ReadTscCounter(Void) {
+    return ReadTsc();
+}
+
+static Void TimerHandler(Registers&, Void*) {
+    Timer::Process();
+}
+
+static InterruptHandler TimerIrq { Null, TimerHandler, Null };
+
 Void IoApic::Free(UInt8 Num) {
     if (Num < Count) AtomicStore(Status[Num], False);
 }
@@ -44,12 +63,13 @@ Void IoApic::Mask(UInt8 Num, Boolean Unmask) {
     else GetRegister(0x10 + Num * 2) = cur | 0x10000;
 }
 
-Void IoApic::Set(UInt8 Num, UInt8 Vector, UInt8 DeliveryMode) {
-    /* Each redirection entry is 64-bits long, with the destination CPU being the last 8 bits of the high word. */
+Void IoApic::Route(UInt8 Num, UInt8 Vector, UInt8 DeliveryMode, UInt8 Destination) {
+    /* Each redirection entry is 64-bits long, with the destination CPU (its LAPIC id) being the last 8 bits of the high
+     * word. */
 
     if (Num >= Count) return;
     GetRegister(0x10 + Num * 2) = (GetRegister(0x10 + Num * 2) & ~0x7FF) | ((DeliveryMode & 0x07) << 8) | Vector;
-    GetRegister(0x11 + Num * 2) = Apic::GetLApicId() << 24;
+    GetRegister(0x11 + Num * 2) = Destination << 24;
 }
 
 Void IoApic::Set(UInt8 Num, UInt8 Vector, Boolean Low, Boolean Level) {
@@ -68,6 +88,10 @@ Void IoApic::GetInfo(UInt8 Num, UInt8 &Vector, Boolean &Low, Boolean &Level) {
     Level = (val >> 15) & 0x01;
 }
 
+UInt8 IoApic::GetDestination(UInt8 Num) {
+    return Num < Count ? GetRegister(0x11 + Num * 2) >> 24 : 0;
+}
+
 Void Apic::Initialize(const Madt *Madt) {
     /* We're the ones that should initialize the LAPIC (find the right physical address and map it to memory), and also
      * the ones that should find and initialize all the IOAPICs (there might be more than one). Finding and
@@ -121,7 +145,7 @@ Void Apic::Initialize(const Madt *Madt) {
         if (cur[0] != 2) continue;
         auto ent = reinterpret_cast<const MadtIoApicSourceOverride*>(&cur[2]);
         Set(ent->Gsi, ent->Irq + 32, ent->Flags & 0x02, ent->Flags & 0x08);
-        IdtSetHandler(ent->Irq, Null);
+        IdtReserveIrq(ent->Irq);
     }
 
     /* We want to make sure we have at least one IOAPIC (and that the LAPIC is properly mapped into virtual memory). */
@@ -155,6 +179,96 @@ Void Apic::SetupLApic(Void) {
     asm volatile("sti");
 }
 
+Void Apic::InitializeTimer(Void) {
+    /* Calibrate both the LAPIC timer and the TSC against the HPET: let the LAPIC timer count down (divided by 16) from
+     * the max value for 10ms, and see how much both it and the TSC advanced. */
+
+    UIntPtr Context;
+    UInt32 ax, bx, cx, dx, max, emax;
+
+    asm volatile("cpuid" : "=a"(max), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+    asm volatile("cpuid" : "=a"(emax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x80000000));
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(1));
+
+    TscDeadline = cx & 0x1000000;
+
+    if (emax >= 0x80000007) {
+        asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x80000007));
+        TscInvariant = dx & 0x100;
+    }
+
+    ARCH_SENSITIVE_START();
+    WriteLApicRegister(0x3E0, 0x03);
+    WriteLApicRegister(0x320, 0x10000);
+
+    UInt64 tsc = ReadTsc(), start = Hpet::ReadRegister(0xF0), end = start + 10000000000000 / Hpet::GetFrequency(), cur;
+
+    WriteLApicRegister(0x380, 0xFFFFFFFF);
+    while ((cur = Hpet::ReadRegister(0xF0)) < end) ARCH_PAUSE();
+
+    UInt64 count = 0xFFFFFFFF - ReadLApicRegister(0x390), ns = (cur - start) * Hpet::GetFrequency() / 1000000;
+
+    tsc = ReadTsc() - tsc;
+    WriteLApicRegister(0x380, 0);
+    ARCH_SENSITIVE_END();
+
+    TscFrequency = tsc * 1000000000 / ns;
+    TimerFrequency = count * 1000000000 / ns;
+
+    /* Newer processors can tell us the exact TSC frequency (ratio between the TSC and the core crystal clock, and the
+     * crystal clock frequency itself), which is better than anything we can measure in 10ms. */
+
+    if (max >= 0x15) {
+        asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x15), "c"(0));
+        if (ax && bx && cx) TscFrequency = static_cast<UInt64>(cx) * bx / ax;
+    }
+
+    /* If the TSC is invariant (constant rate, and doesn't stop on deep C-states), it's way cheaper to read than the
+     * HPET, so use it as the clock source (the cores get synchronized while we're bringing them up). */
+
+    if (TscInvariant && TscFrequency) Timer::SetClockSource("TSC", ReadTscCounter, 1000000000, TscFrequency);
+
+    /* From now on, each core uses its own LAPIC timer for its own timer wheel (if the calibration somehow failed, we
+     * keep using the HPET for everyone). */
+
+    if (!TimerFrequency) {
+        Debug.Write("couldn't calibrate the LAPIC timer, falling back to the HPET for timer events\n");
+        return;
+    }
+
+    IdtAddHandler(0xDC, TimerIrq);
+    SetupTimer();
+
+    Debug.Write("{}calibrated the LAPIC timer ({}Hz{}) and the TSC ({}Hz){}\n", SetForeground { 0xFF00FF00 },
+                TimerFrequency, TscDeadline ? ", using TSC-deadline mode" : "", TscFrequency, RestoreForeground{});
+}
+
+Void Apic::SetupTimer(Void) {
+    /* One-shot mode (or TSC-deadline mode if available) on vector 0xFC, with the divider set to 16 (same as what we
+     * used for the calibration). Switching to TSC-deadline mode requires a fence before the first write to the
+     * deadline MSR. */
+
+    if (!TimerFrequency) return;
+
+    WriteLApicRegister(0x3E0, 0x03);
+    WriteLApicRegister(0x320, 0xFC | (TscDeadline ? 0x40000 : 0));
+
+    if (TscDeadline) asm volatile("mfence" ::: "memory");
+}
+
+Void Apic::ArmTimer(UInt64 Deadline) {
+    /* Deadlines that already passed should fire as soon as possible (writing 0 would disarm the timer instead), and on
+     * one-shot mode anything too far away gets clamped (the timer wheel will just re-arm us once it fires). */
+
+    UInt64 now = Timer::GetUpTime(TimeUnit::Nanoseconds), delta = Deadline > now ? Deadline - now : 0;
+
+    if (TscDeadline) WriteMsr(0x6E0, ReadTsc() + GetCycles(delta, TscFrequency));
+    else {
+        UInt64 count = GetCycles(delta, TimerFrequency);
+        WriteLApicRegister(0x380, !count ? 1 : (count > 0xFFFFFFFF ? 0xFFFFFFFF : count));
+    }
+}
+
 Void Apic::Free(UInt8 Num) {
     for (auto &ent : IoApics) {
         if (Num >= ent.GetBase() && Num < ent.GetCount() + ent.GetCount()) {
@@ -198,10 +312,10 @@ Void Apic::Mask(UInt8 Num, Boolean Unmask) {
     }
 }
 
-Void Apic::Set(UInt8 Num, UInt8 Vector, UInt8 DeliveryMode) {
+Void Apic::Route(UInt8 Num, UInt8 Vector, UInt8 DeliveryMode, UInt8 Destination) {
     for (auto &ent : IoApics) {
         if (Num >= ent.GetBase() && Num < ent.GetBase() + ent.GetCount()) {
-            ent.Set(Num - ent.GetBase(), Vector, DeliveryMode);
+            ent.Route(Num - ent.GetBase(), Vector, DeliveryMode, Destination);
             return;
         }
     }
@@ -224,3 +338,22 @@ Void Apic::GetInfo(UInt8 Num, UInt8 &Vector, Boolean &Low, Boolean &Level) {
         }
     }
 }
+
+UInt8 Apic::GetDestination(UInt8 Num) {
+    for (auto &ent : IoApics)
+        if (Num >= ent.GetBase() && Num < ent.GetBase() + ent.GetCount()) return ent.GetDestination(Num - ent.GetBase());
+    return 0;
+}
+
+TimerWheel &Timer::GetWheel(Void) {
+    /* Each core has its own timer wheel (driven by its own LAPIC timer), unless we're still early on the boot process,
+     * or we don't have the LAPIC timer (in which case everyone uses the BSP wheel, driven by the HPET). */
+
+    return !Apic::GetTimerFrequency() || Smp::GetCoreList().GetLength() <= 1 ? BspWheel :
+                                                                                 *Smp::GetCurrentCore().Wheel;
+}
+
+Void Timer::Arm(UInt64 Deadline) {
+    if (Apic::GetTimerFrequency()) Apic::ArmTimer(Deadline);
+    else Hpet::Arm(Deadline);
+}
@@ -1,10 +1,11 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 20 of 2021, at 19:35 BRT
- * Last edited on July 21 of 2021 at 19:54 BRT */
+ * Last edited on October 19 of 2026 at 23:20 BRT */
 
 #include <arch/acpi.hxx>
 #include <sys/panic.hxx>
+#include <sys/timer.hxx>
 #include <util/bitop.hxx>
 
 using namespace CHicago;
@@ -13,30 +14,43 @@ using namespace CHicago;
 UIntPtr Hpet::Address = 0, Hpet::MinTicks = 0;
 List<Hpet::ComparatorGroup> Hpet::Groups {};
 Boolean Hpet::Initialized = False;
+UInt8 Hpet::EventComparator = 0xFF;
 UInt64 Hpet::Frequency = 0;
 
 static UInt64 GetTicks(TimeUnit Unit, UInt64 Count) {
-    return Count * (Unit == TimeUnit::Nanoseconds ? 1000000 : (Unit == TimeUnit::Microseconds ? 1000000000 :
-                   (Unit == TimeUnit::Milliseconds ? 1000000000000 : 1000000000000000))) / Hpet::GetFrequency();
+    /* The frequency is actually the period (in femtoseconds), so convert everything into nanoseconds, and split the
+     * multiplication, so that we don't overflow on long delays. */
+
+    UInt64 freq = Hpet::GetFrequency(), mul = Unit == TimeUnit::Nanoseconds ? 1 :
+                  (Unit == TimeUnit::Microseconds ? 1000 : (Unit == TimeUnit::Milliseconds ? 1000000 : 1000000000));
+
+    Count = Count > 0xFFFFFFFFFFFFFFFF / mul ? 0xFFFFFFFFFFFFFFFF : Count * mul;
+
+    return (Count / freq) * 1000000 + (Count % freq) * 1000000 / freq;
+}
+
+static UInt64 ReadCounter(Void) {
+    return Hpet::ReadRegister(0xF0);
 }
 
-static Void Handler(Registers &Regs) {
-    UInt64 val = Hpet::ReadRegister(0x20);
+static Void Handler(Registers&, Void *Context) {
+    /* Multiple comparators might share the same IRQ line, so each handler only checks its own comparator (given by the
+     * context). It's level triggered, so we need to clear its status before the EOI. */
 
-    for (auto &group : Hpet::GetGroups()) {
-        if (group.Irq != Regs.IntNum) continue;
-        for (auto &comp : group.Comparators) if (val & (1 << comp.Id)) {
-            Hpet::WriteRegister(0x20, 1 << comp.Id);
-            if (AtomicLoad(comp.Used) && comp.Handler != Null) comp.Handler(&Regs);
-            AtomicStore(comp.Used, False);
-        }
-    }
+    UInt64 mask = 1ull << reinterpret_cast<UIntPtr>(Context);
+
+    if (!(Hpet::ReadRegister(0x20) & mask)) return;
+
+    Hpet::WriteRegister(0x20, mask);
+    Timer::Process();
 }
 
+static InterruptHandler EventIrq { Null, Handler, Null };
+
 Void Hpet::Initialize(const Header *Header) {
-    /* HPET is our main/only timer in x86/amd64 (for now), it's all MMIO, so accessing it is fast (not as fast as
-     * RDTSC), and we can set it up to trigger interrupts every 10ms or so (or less, for sleeping and task
-     * switching). */
+    /* HPET is our main time source in x86/amd64 (for now), and it's also what we use to calibrate the LAPIC timer (and
+     * the TSC). It's all MMIO, so accessing it is fast (not as fast as RDTSC), and we can also use one of its
+     * comparators for the timer events in case we don't have the LAPIC timer. */
 
     ASSERT(!Initialized);
 
@@ -53,7 +67,7 @@ Void Hpet::Initialize(const Header *Header) {
 
     for (UIntPtr i = 0; i < ((caps >> 8) & 0x1F) + 1; i++) {
         UInt8 irq = 0;
-        List<UInt8> valid;
+        List<UInt8, 32> valid;
         Boolean fail = False;
         ComparatorGroup *found = Null;
         UInt64 off = 0x100 + 0x20 * i, val = ReadRegister(off);
@@ -96,8 +110,8 @@ Void Hpet::Initialize(const Header *Header) {
             }
         }
 
-        if (found->Comparators.Add({ i, False, Null }) == Status::Success) {
-            WriteRegister(off, val | (found->Irq << 9) | 0x06);
+        if (found->Comparators.Add(i) == Status::Success) {
+            WriteRegister(off, (val & ~0x04) | (found->Irq << 9) | 0x02);
             count++;
         }
     }
@@ -119,48 +133,47 @@ Void Hpet::Initialize(const Header *Header) {
 
         if (!level) Apic::Set(group.Irq, irq, low, True);
 
-        Apic::Set(group.Irq, irq, 0);
+        Apic::Route(group.Irq, irq, 0, Apic::GetLApicId());
         Apic::Mask(group.Irq, True);
-        IdtSetHandler((group.Irq = irq) - 32, Handler);
+        IdtReserveIrq((group.Irq = irq) - 32);
 
-        /* Setup dummy events on this group, required on QEMU at least (as it seems to send one interrupt to each
-         * counter when you init them, and that could disrupt the SetEvent function). */
+        /* All the timer events are multiplexed into a single comparator (the timer wheel re-arms it for the nearest
+         * deadline), so we only need to enable the interrupts (and add a handler) on the first one that we managed to
+         * route. */
 
-        for (auto &comp : group.Comparators) {
-            AtomicStore(comp.Used, True);
-            Hpet::WriteRegister(0x108 + 0x20 * comp.Id, Hpet::ReadRegister(0xF0) + MinTicks);
-            while (AtomicLoad(comp.Used)) ;
+        if (EventComparator == 0xFF && group.Comparators.GetLength()) {
+            UInt64 off = 0x100 + 0x20 * (EventComparator = group.Comparators[0]);
+            EventIrq.Context = reinterpret_cast<Void*>(static_cast<UIntPtr>(EventComparator));
+            IdtAddHandler(irq - 32, EventIrq);
+            WriteRegister(off, ReadRegister(off) | 0x04);
         }
     }
 
     Debug.Write("{}initialized the HPET (frequency of {}Hz and {} comparators){}\n", SetForeground { 0xFF00FF00 },
                 1000000000000000 / Frequency, count, RestoreForeground{});
-}
 
-Boolean Timer::SetEvent(TimeUnit Unit, UInt64 Count, Void (*Handler)(Void*)) {
-    if (Handler == Null || !Hpet::IsInitialized()) return False;
+    /* Use the main counter as the clock source until (and unless) we find something better (the period is in
+     * femtoseconds, so each tick is Frequency/10^6 nanoseconds). */
+
+    Timer::SetClockSource("HPET", ReadCounter, Frequency, 1000000);
+}
 
-    UInt64 dest = Hpet::ReadRegister(0xF0), ticks = GetTicks(Unit, Count);
-    dest += ticks < Hpet::GetMinTicks() ? Hpet::GetMinTicks() : ticks;
+Void Hpet::Arm(UInt64 Deadline) {
+    /* This is only used if we don't have the LAPIC timer (or while it's not calibrated yet). The comparator only fires
+     * when the main counter matches it, so we need to make sure that we're not trying to set something that already
+     * passed (or that is going to pass before the write lands). */
 
-    for (auto &group : Hpet::GetGroups()) for (auto &comp : group.Comparators) if (!AtomicExchange(comp.Used, True)) {
-        comp.Handler = Handler;
-        Hpet::WriteRegister(0x108 + 0x20 * comp.Id, dest - Hpet::ReadRegister(0xF0) < Hpet::GetMinTicks() ?
-                                                           Hpet::ReadRegister(0xF0) + Hpet::GetMinTicks() : dest);
-        return True;
-    }
+    if (!Initialized || EventComparator == 0xFF) return;
 
-    return False;
-}
+    /* The deadline is on the clock source timeline (which might not be the HPET itself), so convert only how far into
+     * the future it is. */
 
-Void Timer::Sleep(TimeUnit Unit, UInt64 Count) {
-    if (!Hpet::IsInitialized()) return;
-    for (UInt64 dest = Hpet::ReadRegister(0xF0) + GetTicks(Unit, Count); Hpet::ReadRegister(0xF0) < dest;) ARCH_PAUSE();
-}
+    UInt64 off = 0x108 + 0x20 * EventComparator, now = Timer::GetUpTime(TimeUnit::Nanoseconds),
+           dest = ReadRegister(0xF0) + GetTicks(TimeUnit::Nanoseconds, Deadline > now ? Deadline - now : 0);
 
-UInt64 Timer::GetUpTime(TimeUnit Unit) {
-    if (!Hpet::IsInitialized()) return 0;
-    return (Hpet::ReadRegister(0xF0) * Hpet::GetFrequency()) /
-           (Unit == TimeUnit::Nanoseconds ? 1000000 : (Unit == TimeUnit::Microseconds ? 1000000000 :
-           (Unit == TimeUnit::Milliseconds ? 1000000000000 : 1000000000000000)));
+    do {
+        UInt64 now = ReadRegister(0xF0);
+        if (dest < now + MinTicks) dest = now + MinTicks;
+        WriteRegister(off, dest);
+    } while (ReadRegister(0xF0) >= dest);
 }
@@ -0,0 +1,137 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 16:20 BRT
+ * Last edited on October 20 of 2026, at 09:10 BRT */
+
+#include <arch/acpi.hxx>
+
+using namespace CHicago;
+
+UIntPtr Irq::NextCore = 0;
+
+Boolean Irq::Allocate(UIntPtr &Core, UInt8 &Vector) {
+    /* Allocate a vector on the given core, or, if the caller passed IRQ_ANY_CORE, on the next core (that we can
+     * target) after the one we used last time. Core and Vector get the core/vector that we actually used (the vector
+     * being the IDT handler index, so the actual vector is Vector + 32). */
+
+    UInt8 dest;
+    UIntPtr count = Smp::GetCoreList().GetLength();
+
+    if (Core != IRQ_ANY_CORE) return GetDestination(Core, dest) && (Vector = IdtAllocIrq(Core)) != 0xFF;
+    else if (count <= 1) return GetDestination(Core = 0, dest) && (Vector = IdtAllocIrq(Core)) != 0xFF;
+
+    for (UIntPtr i = 0, start = AtomicFetchAdd(NextCore, 1); i < count; i++) {
+        Core = (start + i) % count;
+        if (GetDestination(Core, dest) && (Vector = IdtAllocIrq(Core)) != 0xFF) return True;
+    }
+
+    return False;
+}
+
+Void Irq::Free(UIntPtr Core, UInt8 Vector) {
+    IdtFreeIrq(Core, Vector);
+}
+
+Boolean Irq::Route(UInt8 Gsi, InterruptHandler &Handler, UIntPtr Core) {
+    /* The caller should have already allocated the GSI (Apic::Alloc), we just need to allocate a vector on the target
+     * core, add the handler, and point the IOAPIC redirection entry to it (keeping the polarity/trigger mode, which
+     * might have been overridden by the MADT). */
+
+    UInt8 vec, old, dest;
+    Boolean low, level;
+
+    if (!Allocate(Core, vec)) return False;
+    else if (!GetDestination(Core, dest) || !IdtAddHandler(Core, vec, Handler)) {
+        Free(Core, vec);
+        return False;
+    }
+
+    Apic::GetInfo(Gsi, old, low, level);
+    Apic::Set(Gsi, vec + 32, low, level);
+    Apic::Route(Gsi, vec + 32, 0, dest);
+    Apic::Mask(Gsi, True);
+
+    return True;
+}
+
+Boolean Irq::Unroute(UInt8 Gsi, InterruptHandler &Handler) {
+    /* Undo what Route did: mask the pin, and use the redirection entry itself to find the core/vector that we used. */
+
+    UInt8 vec;
+    UIntPtr core;
+    Boolean low, level;
+
+    Apic::Mask(Gsi, False);
+    Apic::GetInfo(Gsi, vec, low, level);
+
+    if (vec < 32 || (core = GetCore(Apic::GetDestination(Gsi))) == IRQ_ANY_CORE ||
+        !IdtRemoveHandler(core, vec - 32, Handler)) return False;
+
+    Free(core, vec - 32);
+
+    return True;
+}
+
+Boolean Irq::ComposeMsi(UIntPtr Core, UInt8 Vector, Boolean Level, MsiMessage &Message) {
+    /* Address: 0xFEE00000 with the destination LAPIC id on bits 12-19 (physical destination mode, no redirection
+     * hint); Data: the vector, fixed delivery mode, and the trigger mode (level triggered messages also need the
+     * assert bit). */
+
+    UInt8 dest;
+
+    if (Vector >= 224 || !GetDestination(Core, dest)) return False;
+
+    Message.Address = 0xFEE00000 | (static_cast<UInt64>(dest) << 12);
+    Message.Data = (Vector + 32) | (Level ? 0xC000 : 0);
+
+    return True;
+}
+
+Boolean Irq::AllocateMsi(InterruptHandler &Handler, MsiMessage &Message, UIntPtr Core) {
+    /* MSIs are always edge triggered for us (and each one gets its own vector, so there is no sharing), the caller
+     * just needs to write the message into the MSI capability (or into the MSI-X table entry). */
+
+    UInt8 vec;
+
+    if (!Allocate(Core, vec)) return False;
+    else if (!ComposeMsi(Core, vec, False, Message) || !IdtAddHandler(Core, vec, Handler)) {
+        Free(Core, vec);
+        return False;
+    }
+
+    return True;
+}
+
+Boolean Irq::FreeMsi(const MsiMessage &Message, InterruptHandler &Handler) {
+    /* The caller should have already disabled/masked the MSI on the device itself. */
+
+    UInt8 vec = Message.Data & 0xFF;
+    UIntPtr core = GetCore((Message.Address >> 12) & 0xFF);
+
+    if (vec < 32 || core == IRQ_ANY_CORE || !IdtRemoveHandler(core, vec - 32, Handler)) return False;
+
+    Free(core, vec - 32);
+
+    return True;
+}
+
+Boolean Irq::GetDestination(UIntPtr Core, UInt8 &Destination) {
+    /* Early on (before SMP initialization), the BSP is the only core that we have. Cores that are not online yet can't
+     * be targeted, and neither can cores with LAPIC ids that don't fit into 8-bits. */
+
+    auto &list = Smp::GetCoreList();
+
+    if (list.GetLength() <= 1) return !Core && Apic::GetLApicId() <= 0xFF && (Destination = Apic::GetLApicId(), True);
+    else if (Core >= list.GetLength() || !AtomicLoad(list[Core].Status) || list[Core].LApicId > 0xFF) return False;
+
+    return Destination = list[Core].LApicId, True;
+}
+
+UIntPtr Irq::GetCore(UInt8 Destination) {
+    auto &list = Smp::GetCoreList();
+
+    if (list.GetLength() <= 1) return Destination == Apic::GetLApicId() ? 0 : IRQ_ANY_CORE;
+    for (auto &core : list) if (core.LApicId == Destination) return core.Id;
+
+    return IRQ_ANY_CORE;
+}
@@ -1,41 +1,66 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 20 of 2021, at 19:42 BRT
- * Last edited on July 21 of 2021, at 20:03 BRT */
+ * Last edited on October 20 of 2026, at 10:40 BRT */
 
 #include <arch/acpi.hxx>
+#include <arch/fpu.hxx>
 #include <sys/panic.hxx>
+#include <sys/timer.hxx>
 
 using namespace CHicago;
 
 extern "C" Void SmpTrampoline(Void);
 
 extern Gdt BspGdt;
-extern "C" UInt32 SmpTrampolineCr3;
-extern "C" CoreInfo *SmpTrampolineCoreInfo;
+extern TimerWheel BspWheel;
+extern RunQueue BspQueue;
+extern RcuData BspRcu;
+extern InterruptTable BspInterrupts;
+extern WorkQueue BspWork;
+extern CallQueue BspCalls;
+extern "C" UInt32 SmpTrampolineCr3, SmpTrampolineCoreCount;
+extern "C" UInt8 SmpTrampolineCores;
+
+/* The trampoline has a table of these right at its end, and each AP searches for its own LAPIC id in there (that's how
+ * all of them can come up at the same time). */
+
+struct SmpBootEntry {
+    UIntPtr LApicId;
+    CoreInfo *Info;
+};
 
-UIntPtr Smp::TlbShootdownAddress = 0, Smp::TlbShootdownSize = 0, Smp::TlbShootdownLeft = 0;
 List<CoreInfo> Smp::CoreList {};
+volatile UIntPtr Smp::TscSyncCore = UINTPTR_MAX;
+volatile UInt32 Smp::TscSyncState = 0;
+volatile UInt64 Smp::TscSyncValue = 0;
+
+static UIntPtr GetTrampolineOffset(const Void *Symbol) {
+    return reinterpret_cast<UIntPtr>(Symbol) - reinterpret_cast<UIntPtr>(SmpTrampoline);
+}
 
 Void Arch::InitializeCore(Void) {
-    auto &info = **reinterpret_cast<CoreInfo**>(0x8000 + reinterpret_cast<UIntPtr>(&SmpTrampolineCoreInfo) -
-                                                reinterpret_cast<UIntPtr>(SmpTrampoline));
+    /* The trampoline already switched into the stack of our CoreInfo, so that's how we find it. */
+
+    UIntPtr sp = reinterpret_cast<UIntPtr>(__builtin_frame_address(0));
+    CoreInfo *cur = Null;
+
+    for (auto &ent : Smp::GetCoreList()) {
+        if (sp - reinterpret_cast<UIntPtr>(ent.KernelStack) < 0x2000) {
+            cur = &ent;
+            break;
+        }
+    }
+
+    if (cur == Null) Arch::Halt(True);
+
+    auto &info = *cur;
 
-    /* Initialize the FPU (SSE+AVX2) support. */
+    /* Initialize the FPU support (XCR0 gets the same state components that the BSP enabled, including AVX-512). */
 
     UInt16 cw0 = 0x37E, cw1 = 0x37A;
-    asm volatile("fninit; fldcw %0; fldcw %1\n"
-                 #ifdef __i386__
-                 "xor %%ecx, %%ecx; xgetbv; or $0x07, %%eax; xsetbv\n"
-                 #else
-                 "xor %%rcx, %%rcx; xgetbv; or $0x07, %%rax; xsetbv\n"
-#endif
-    :: "m"(cw0), "m"(cw1)
-#ifdef __i386__
-    : "%eax", "%ecx", "%edx");
-#else
-    : "%rax", "%rcx", "%rdx");
-#endif
+    asm volatile("fninit; fldcw %0; fldcw %1" :: "m"(cw0), "m"(cw1));
+    Fpu::InitializeCore();
 
     /* The IDT struct can be used as is, but the GDT needs to be per core (because of the TSS). */
 
@@ -50,6 +75,9 @@ Void Arch::InitializeCore(Void) {
 
     IdtReload();
     Apic::SetupLApic();
+    Apic::SetupTimer();
+    Smp::SyncTsc(info, False);
+    Call::Initialize();
     asm volatile("sti");
 }
 
@@ -61,35 +89,61 @@ Void Arch::FinishCore(Void) {
     AtomicStore(Smp::GetCurrentCore().Status, True);
 }
 
+Boolean Smp::AddCore(UInt32 LApicId) {
+    /* We have to be very careful with allocating the CPU/core structure, as SMP initialization will break if the
+     * address 0x8000 is not available. Fortunately, our allocator should be configured to skip pages in the first
+     * MiB. Everything the core needs is allocated up front, and if anything fails, we free whatever we got and just
+     * skip the core. */
+
+    auto stack = new UInt8[0x2000 + sizeof(Gdt)];
+    auto wheel = new TimerWheel(CoreList.GetLength());
+    auto queue = new RunQueue();
+    auto rcu = new RcuData();
+    auto irqs = new InterruptTable();
+    auto work = new WorkQueue();
+    auto calls = new CallQueue();
+
+    if (stack != Null && wheel != Null && queue != Null && rcu != Null && irqs != Null && work != Null &&
+        calls != Null &&
+        CoreList.Add({ Null, reinterpret_cast<Gdt*>(&stack[0x2000]), CoreList.GetLength(), LApicId, False, stack,
+                       wheel, queue, Null, 0, rcu, irqs, work, calls }) == Status::Success) return True;
+
+    delete[] stack;
+    delete wheel;
+    delete queue;
+    delete rcu;
+    delete irqs;
+    delete work;
+    delete calls;
+
+    return False;
+}
+
 Void Smp::Initialize(const BootInfo &Info, const Apic::Madt *Header) {
-    ASSERT(CoreList.Add({ Null, &BspGdt, 0, Apic::GetLApicId(), True, Info.KernelStack }) == Status::Success);
+    ASSERT(CoreList.Add({ Null, &BspGdt, 0, Apic::GetLApicId(), True, Info.KernelStack, &BspWheel, &BspQueue, Null, 0,
+                          &BspRcu, &BspInterrupts, &BspWork, &BspCalls }) == Status::Success);
 
     UIntPtr id = CoreList[0].LApicId;
+    Boolean all = True;
 
     for (auto cur = Header->Records;
          reinterpret_cast<UIntPtr>(cur) < reinterpret_cast<UIntPtr>(Header) + Header->Header.Length; cur += cur[1]) {
         if (!cur[0]) {
-            /* We have to be very careful with allocating the CPU/core structure, as SMP initialization will break
-             * if the address 0x8000 is not available. Fortunately, our allocator should be configured to skip
-             * pages in the first MiB. */
-
-            if (!(cur[4] & 0x01) || cur[3] == id) continue;
-
-            auto stack = new UInt8[0x2000 + sizeof(Gdt)];
-            if (stack != Null &&
-                CoreList.Add({ Null, reinterpret_cast<Gdt*>(&stack[0x2000]), CoreList.GetLength(), cur[3], False,
-                               stack }) != Status::Success) delete[] stack;
+            if (cur[3] == id) continue;
+            else if (!(cur[4] & 0x01)) {
+                all = False;
+                continue;
+            } else if (!AddCore(cur[3])) all = False;
         } else if (cur[0] == 9) {
             /* This is the same as above, but using a 32-bit x2APIC id instead of a 8-bit xAPIC id. */
 
             auto core = reinterpret_cast<const Apic::MadtX2Apic*>(&cur[2]);
 
-            if (!(core->Flags & 0x01) || core->CoreId == id) continue;
-
-            auto stack = new UInt8[0x2000 + sizeof(Gdt)];
-            if (stack != Null &&
-                CoreList.Add({ Null, reinterpret_cast<Gdt*>(&stack[0x2000]), CoreList.GetLength(), core->CoreId, False,
-                               stack }) != Status::Success) delete[] stack;
+            if (core->CoreId == id) continue;
+            else if (!(core->Flags & 0x01)) {
+                all = False;
+                continue;
+            } else if (!AddCore(core->CoreId)) all = False;
         }
     }
 
@@ -109,45 +163,58 @@ Void Smp::Initialize(const BootInfo &Info, const Apic::Madt *Header) {
 
     /* Local APIC is necessary for initializing SMP, and it doesn't require any timer function (which we might not have
      * yet), so let's set it up: Interrupts are already disabled/masked, so we just need to setup the LAPIC itself and
-     * sti. */
+     * sti. The BSP can also start receiving cross-core calls (the APs do the same in Arch::InitializeCore). */
 
-    IdtSetHandler(0xDD, TlbShootdownHandler);
+    Call::Initialize();
 
     Debug.Write("detected {} core(s)\n", CoreList.GetLength());
     if (CoreList.GetLength() <= 1) return;
 
-    auto addr = reinterpret_cast<UInt32*>(0x8000 + reinterpret_cast<UIntPtr>(&SmpTrampolineCr3) -
-                                          reinterpret_cast<UIntPtr>(SmpTrampoline));
-    UIntPtr size = reinterpret_cast<UIntPtr>(&SmpTrampolineCoreInfo) - reinterpret_cast<UIntPtr>(SmpTrampoline) +
-                   sizeof(Void*);
+    auto addr = reinterpret_cast<UInt32*>(0x8000 + GetTrampolineOffset(&SmpTrampolineCr3));
+    auto count = reinterpret_cast<UInt32*>(0x8000 + GetTrampolineOffset(&SmpTrampolineCoreCount));
+    auto table = reinterpret_cast<SmpBootEntry*>(0x8000 + GetTrampolineOffset(&SmpTrampolineCores));
+    UIntPtr code = GetTrampolineOffset(&SmpTrampolineCores),
+            size = code + (CoreList.GetLength() - 1) * sizeof(SmpBootEntry);
 
     size += -size & PAGE_MASK;
 
     /* Our bootstrap code should be in low physical memory (0x8000), said address (actually, anything up to 1MiB of
-     * phys mem) should be free for use. */
+     * phys mem) should be free for use. The core table goes right after the code. */
 
     ASSERT(VirtMem::Map(0x8000, 0x8000, size, MAP_KERNEL | MAP_RW | MAP_EXEC) == Status::Success);
-    CopyMemory(reinterpret_cast<Void*>(0x8000), reinterpret_cast<const Void*>(SmpTrampoline), size);
+    CopyMemory(reinterpret_cast<Void*>(0x8000), reinterpret_cast<const Void*>(SmpTrampoline), code);
 #ifdef __i386__
     asm volatile("mov %%cr3, %%eax; mov %%eax, %0" : "=r"(*addr));
 #else
     asm volatile("mov %%cr3, %%rax; mov %%eax, %0" : "=r"(*addr));
 #endif
 
+    *count = 0;
+
     for (auto &info : CoreList) {
-        if (info.Status) continue;
+        if (!info.Status) table[(*count)++] = { info.LApicId, &info };
+    }
 
-        *reinterpret_cast<CoreInfo**>(0x8000 + reinterpret_cast<UIntPtr>(&SmpTrampolineCoreInfo) -
-                                      reinterpret_cast<UIntPtr>(SmpTrampoline)) = &info;
+    /* Bring everyone up at the same time: INIT, wait 10ms, SIPI (modern CPUs, pretty much everything since the original
+     * Pentiums, generally don't need more than a single SIPI, and of course there is no need for the INIT deassert IPI).
+     * If every core in the MADT is enabled and made into the core list, we can use the all-excluding-self shorthand
+     * (2 IPIs in total), else we need to target each core (so that we don't wake up anything we're not expecting, even
+     * though the trampoline just halts any core that isn't on the table). */
 
-        /* Modern CPUs (pretty much everything since the original Pentiums) generally don't need more than a single
-         * SIPI (and of course there is no need for the INIT deassert IPI). */
+    if (all) SendIpi(2, 0, 0x4500);
+    else for (UIntPtr i = 0; i < *count; i++) SendIpi(0, table[i].LApicId, 0x4500);
 
-        SendIpi(0, info.LApicId, 0x4500);
-        Timer::Sleep(TimeUnit::Milliseconds, 10);
-        SendIpi(0, info.LApicId, 0x4608);
+    Timer::Sleep(TimeUnit::Milliseconds, 10);
 
-        while (!AtomicLoad(info.Status)) ARCH_PAUSE();
+    if (all) SendIpi(2, 0, 0x4608);
+    else for (UIntPtr i = 0; i < *count; i++) SendIpi(0, table[i].LApicId, 0x4608);
+
+    /* TSC sync is still done one core at a time (each AP waits for its turn), but that only takes a few round trips
+     * per core. */
+
+    for (UIntPtr i = 0; i < *count; i++) {
+        SyncTsc(*table[i].Info, True);
+        while (!AtomicLoad(table[i].Info->Status)) ARCH_PAUSE();
     }
 
     VirtMem::Unmap(0x8000, size);
@@ -155,43 +222,108 @@ Void Smp::Initialize(const BootInfo &Info, const Apic::Madt *Header) {
 
 
 Void Smp::SendIpi(UInt8 Type, UInt32 Dest, UInt16 Vector) {
+    /* On xAPIC, the destination and the command are two separate writes, and an interrupt handler that sends its own
+     * IPI between them (scheduler wakeups, work triggers, etc) would overwrite our destination, so the whole thing
+     * needs to run with interrupts disabled. */
+
+    UIntPtr Context;
     UInt64 val = (Vector & ~0xFFFF3000) | (!Type ? 0 : (Type == 1 ? 0x80000 : 0xC0000));
 
     if (!Apic::IsInitialized()) return;
     else if (!Apic::GetLApicAddress()) Apic::WriteLApicRegister(0x300, ((UInt64)Dest << 32) | val);
     else {
+        ARCH_SENSITIVE_START();
         Apic::WriteLApicRegister(0x310, Dest << 24);
         Apic::WriteLApicRegister(0x300, val);
         do { ARCH_PAUSE(); } while (Apic::ReadLApicRegister(0x300) & 0x1000);
+        ARCH_SENSITIVE_END();
     }
 }
 
+struct ShootdownRange {
+    UIntPtr Address, Size;
+};
+
 Void Smp::SendTlbShootdown(UIntPtr Address, UIntPtr Size) {
-    /* When unmapping something we need to warn the other cores that they need to update their TLB, for this, we use a
-     * TLB shootdown IPI (vector 0xFD here in CHicago). The lock is so that if multiple cores are trying to update
-     * each other, they sync correctly. */
+    /* When unmapping something we need to warn the other cores that they need to update their TLB (we already did our
+     * own). This is just a synchronous cross-core call, so multiple cores can be doing shootdowns at the same time
+     * (each one with its own range). */
 
     if (!Apic::IsInitialized() || CoreList.GetLength() <= 1) return;
-    static SpinLock lock;
-    lock.Acquire();
 
-    TlbShootdownAddress = Address;
-    TlbShootdownSize = Size;
-    TlbShootdownLeft = 0;
+    ShootdownRange range { Address, Size };
+    Call::RunOnAll(TlbShootdownHandler, &range, False);
+}
+
+Void Smp::SyncTsc(const CoreInfo &Info, Boolean Bsp) {
+    /* Each core has its own TSC, and they are not guaranteed to start in sync (or to stay in sync after the firmware
+     * messes with them), so, if we're using the TSC as the clock source, sync each AP with the BSP as it comes up. The
+     * BSP asks the AP for its TSC a few times, and takes the sample with the smallest round trip, assuming that the AP
+     * read it right in the middle of the round trip. The AP then fixes its own TSC using the difference (preferably
+     * using IA32_TSC_ADJUST, as it doesn't race with the counter itself). Info is always the AP being synced (on both
+     * sides), so the caller needs to tell us which side of the handshake it is. */
+
+    if (!Apic::IsTscInvariant()) return;
+    else if (Bsp) {
+        UInt64 best = 0xFFFFFFFFFFFFFFFF;
+        Int64 off = 0;
+
+        AtomicStore(TscSyncState, 0);
+        AtomicStore(TscSyncCore, Info.Id);
+        while (AtomicLoad(TscSyncState) != 2) ARCH_PAUSE();
+
+        for (UIntPtr i = 0; i < 64; i++) {
+            UInt64 start = ReadTsc();
+            AtomicStore(TscSyncState, 1);
+            while (AtomicLoad(TscSyncState) != 2) ARCH_PAUSE();
+
+            UInt64 end = ReadTsc(), rtt = end - start;
+
+            if (rtt < best) {
+                best = rtt;
+                off = static_cast<Int64>(AtomicLoad(TscSyncValue) - (start + rtt / 2));
+            }
+        }
 
-    for (auto &info : CoreList) {
-        if (!info.Status || info.LApicId == Apic::GetLApicId()) continue;
-        SendIpi(0, info.LApicId, 0xFD);
-        AtomicAddFetch(TlbShootdownLeft, 1);
-    };
+        /* Anything inside the error margin isn't worth fixing (writing to the TSC isn't free of error either). */
+
+        if (static_cast<UInt64>(off < 0 ? -off : off) <= best / 2) off = 0;
+
+        AtomicStore(TscSyncValue, static_cast<UInt64>(off));
+        AtomicStore(TscSyncState, 3);
+        while (AtomicLoad(TscSyncState)) ARCH_PAUSE();
+        AtomicStore(TscSyncCore, UINTPTR_MAX);
+
+        return;
+    }
+
+    UInt32 state, ax, bx, cx, dx;
+
+    while (AtomicLoad(TscSyncCore) != Info.Id) ARCH_PAUSE();
+    AtomicStore(TscSyncState, 2);
+
+    while (True) {
+        while ((state = AtomicLoad(TscSyncState)) == 2) ARCH_PAUSE();
+        if (state == 3) break;
+        AtomicStore(TscSyncValue, ReadTsc());
+        AtomicStore(TscSyncState, 2);
+    }
+
+    UInt64 off = AtomicLoad(TscSyncValue);
+
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+
+    if (ax >= 7) asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(7), "c"(0));
+    else bx = 0;
 
-    while (AtomicLoad(TlbShootdownLeft)) ARCH_PAUSE();
+    if (off && (bx & 0x02)) WriteMsr(0x3B, ReadMsr(0x3B) - off);
+    else if (off) WriteMsr(0x10, ReadTsc() - off);
 
-    lock.Release();
+    AtomicStore(TscSyncState, 0);
 }
 
-Void Smp::TlbShootdownHandler(Registers&) {
-    for (UIntPtr i = 0; i < TlbShootdownSize; i += PAGE_SIZE)
-            asm volatile("invlpg (%0)" :: "r"(TlbShootdownAddress + i) : "memory");
-    AtomicSubFetch(TlbShootdownLeft, 1);
+Void Smp::TlbShootdownHandler(Void *Context) {
+    auto range = static_cast<ShootdownRange*>(Context);
+    for (UIntPtr i = 0; i < range->Size; i += PAGE_SIZE)
+        asm volatile("invlpg (%0)" :: "r"(range->Address + i) : "memory");
 }
@@ -1,16 +1,19 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on June 29 of 2020, at 11:24 BRT
- * Last edited on July 21 of 2021, at 17:58 BRT */
+ * Last edited on October 20 of 2026, at 10:20 BRT */
 
 #include <arch/acpi.hxx>
+#include <arch/fpu.hxx>
 #include <arch/port.hxx>
 #include <sys/arch.hxx>
 #include <sys/panic.hxx>
 
 namespace CHicago {
 
-struct { volatile Boolean Used; InterruptHandlerFunc Handler; } InterruptHandlers[224] {};
+struct { volatile Boolean Used; InterruptHandler *volatile Head; } InterruptHandlers[224] {};
+InterruptTable BspInterrupts {};
+static SpinLock AllocLock {};
 static UInt8 IdtEntries[256][2 * sizeof(UIntPtr)];
 static DescTablePointer IdtPointer;
 
@@ -24,14 +27,57 @@ static const Char *ExceptionStrings[32] = {
 	"security exception", "reserved"
 };
 
-extern "C" force_align_arg_pointer Void IdtDefaultHandler(Registers &Regs) {
+/* Removed handlers have the lowest bit of their Next pointer set (the structs are always at least pointer aligned),
+ * which makes any concurrent attempt to link/unlink something right after them fail (and retry). */
+
+static inline Boolean IsRemoved(InterruptHandler *Pointer) {
+    return reinterpret_cast<UIntPtr>(Pointer) & 1;
+}
+
+static inline InterruptHandler *SetRemoved(InterruptHandler *Pointer) {
+    return reinterpret_cast<InterruptHandler*>(reinterpret_cast<UIntPtr>(Pointer) | 1);
+}
+
+static inline InterruptHandler *GetPointer(InterruptHandler *Pointer) {
+    return reinterpret_cast<InterruptHandler*>(reinterpret_cast<UIntPtr>(Pointer) & ~1);
+}
+
+static InterruptTable *GetTable(UIntPtr Id) {
+    auto &list = Smp::GetCoreList();
+    return list.GetLength() <= 1 ? (!Id ? &BspInterrupts : Null) : (Id < list.GetLength() ? list[Id].Interrupts : Null);
+}
+
+static Void Dispatch(InterruptHandler *Head, Registers &Regs) {
+    /* We're already inside a RCU read-side section (interrupts are disabled), so walking the list needs no
+     * synchronization at all (handlers that are being removed are skipped, but they're only freed after we leave). */
+
+    for (InterruptHandler *cur = Head, *next; cur != Null; cur = GetPointer(next))
+        if (!IsRemoved(next = AtomicLoad(cur->Next, __ATOMIC_ACQUIRE))) cur->Function(Regs, cur->Context);
+}
+
+extern "C" force_align_arg_pointer Registers *IdtDefaultHandler(Registers &Regs) {
 	/* 'regs' contains information about the interrupt that we received, we can determine whatever this is an exception
 	 * or some device interrupt using the interrupt number: 0-31 is ALWAYS exceptions (at least on the way that we
-	 * configured the PIC); 32-255 are device interrupts/OS interrupts (like system calls). */
+	 * configured the PIC); 32-255 are device interrupts/OS interrupts (like system calls). RCU readers run with
+	 * interrupts disabled, so whatever we interrupted can't be inside a read-side section (which makes this a
+	 * quiescent state). Interrupts can nest (while we're running the deferred work), and only the outermost one deals
+	 * with the lazy FPU state, the deferred work and the scheduler. */
+
+	InterruptTable *table = Regs.IntNum >= 32 ? GetTable(Arch::GetCoreId()) : Null;
+	Boolean nested = table != Null && table->Depth++;
+
+	if (Regs.IntNum >= 32) {
+	    if (!nested) Fpu::EnterInterrupt();
+	    Rcu::Quiescent();
+	} else if (Regs.IntNum == 7 && Fpu::HandleFault()) return &Regs;
+
+	if (Regs.IntNum >= 32) {
+	    /* Each vector has a list of handlers that run on every core, and another one that only runs on this core (for
+	     * vectors that were allocated per-core). */
 
-	if (Regs.IntNum >= 32 && InterruptHandlers[Regs.IntNum - 32].Handler != Null)
-	    InterruptHandlers[Regs.IntNum - 32].Handler(Regs);
-	else if (Regs.IntNum < 32) {
+	    Dispatch(AtomicLoad(InterruptHandlers[Regs.IntNum - 32].Head, __ATOMIC_ACQUIRE), Regs);
+	    if (table != Null) Dispatch(AtomicLoad(table->Heads[Regs.IntNum - 32], __ATOMIC_ACQUIRE), Regs);
+	} else {
 	    StringView name;
 	    UIntPtr cr0, cr2, cr3, cr4, off;
         asm volatile("mov %%cr0, %0; mov %%cr2, %1; mov %%cr3, %2; mov %%cr4, %3" : "=r"(cr0), "=r"(cr2), "=r"(cr3),
@@ -74,21 +120,118 @@ extern "C" force_align_arg_pointer Void IdtDefaultHandler(Registers &Regs) {
 	    Arch::Halt(True);
 	}
 
-    if (Regs.IntNum >= 32) {
+    if (Regs.IntNum >= 32 && Regs.IntNum != 0xFB) {
         /* When APIC is enabled, we just need to send the EOI to it, when it isn't, we need to send it to the PIC
-         * (master channel if it is IRQs 0-7 and slave channel for anything else). */
+         * (master channel if it is IRQs 0-7 and slave channel for anything else). 0xFB is the software interrupt used
+         * by the scheduler, so it doesn't need any EOI. */
 
         if (Apic::IsInitialized()) Apic::WriteLApicRegister(0xB0, 0);
         else if (Regs.IntNum >= 40) Port::OutByte(0xA0, 0x20);
         else Port::OutByte(0x20, 0x20);
     }
+
+    /* Now that the EOI was sent, run whatever work the handlers deferred, with interrupts enabled (so that other
+     * interrupts don't need to wait for it). The scheduler might want to switch to another thread, in which case we
+     * return its saved frame (instead of the one that we got), and IdtCommonStub switches into its stack before
+     * restoring everything. Lazy FPU switching is only done after that (so that the handler/scheduler can't clobber
+     * the FPU state of the thread that we're returning to). Hardware interrupts can only come in with interrupts
+     * enabled, but the scheduler's software interrupt (0xFB) is raised by code that disabled them on purpose (Block,
+     * Exit, etc), and enabling them here would let an IRQ in right in the middle of that; so if the interrupted code
+     * had them disabled, the work just waits for the next interrupt. */
+
+    if (Regs.IntNum < 32) return &Regs;
+    else if (nested) return table->Depth--, &Regs;
+
+    if (Regs.Flags & 0x200) {
+        asm volatile("sti");
+        Work::Run();
+        asm volatile("cli");
+    }
+
+    if (table != Null) table->Depth--;
+
+    auto res = static_cast<Registers*>(Scheduler::Schedule(&Regs));
+    Fpu::ExitInterrupt();
+
+    return res;
 }
 
-Void IdtSetHandler(UInt8 Num, InterruptHandlerFunc Func) {
-	if (Num < 224) {
-	    AtomicStore(InterruptHandlers[Num].Used, True);
-	    InterruptHandlers[Num].Handler = Func;
-	}
+extern "C" force_align_arg_pointer Void IdtFinishSwitch(Void) {
+    /* IdtCommonStub calls us after switching into the stack of the thread that Scheduler::Schedule picked. */
+
+    Scheduler::FinishSwitch();
+}
+
+static Void AddHandler(InterruptHandler *volatile &Head, InterruptHandler &Handler) {
+    /* New handlers go into the start of the list (CAS loop, so multiple cores can add handlers at the same time, without
+     * any lock). */
+
+    InterruptHandler *head;
+
+    do Handler.Next = head = AtomicLoad(Head);
+    while (!AtomicCompareExchange(Head, head, &Handler));
+}
+
+static Boolean RemoveHandler(InterruptHandler *volatile &Head, InterruptHandler &Handler) {
+    /* First, mark the handler as removed (the interrupt handler stops calling it from now on, and nobody can link
+     * anything after it anymore), and then unlink it from whatever points to it (if that fails, someone changed the
+     * list under us, so just start again from the head). At the end, we need to wait for a RCU grace period, as other
+     * cores might still be running it (so this can't be called from an interrupt handler). */
+
+    InterruptHandler *next;
+
+    do if (IsRemoved(next = AtomicLoad(Handler.Next))) return False;
+    while (!AtomicCompareExchange(Handler.Next, next, SetRemoved(next)));
+
+    while (True) {
+        InterruptHandler *volatile *prev = &Head, *cur;
+
+        while ((cur = AtomicLoad(*prev)) != Null && GetPointer(cur) != &Handler)
+            prev = &GetPointer(cur)->Next;
+
+        if (cur == Null || AtomicCompareExchange(*prev, &Handler, next)) break;
+    }
+
+    Rcu::Synchronize();
+
+    return True;
+}
+
+Boolean IdtAddHandler(UInt8 Num, InterruptHandler &Handler) {
+    /* Handlers added here run on every core (and the vector becomes reserved everywhere, so that IdtAllocIrq doesn't
+     * give it out). */
+
+    if (Num >= 224 || Handler.Function == Null) return False;
+
+    AtomicStore(InterruptHandlers[Num].Used, True);
+    AddHandler(InterruptHandlers[Num].Head, Handler);
+
+    return True;
+}
+
+Boolean IdtAddHandler(UIntPtr Core, UInt8 Num, InterruptHandler &Handler) {
+    /* Same as above, but only for the given core (the vector should have been allocated using IdtAllocIrq(Core)). */
+
+    InterruptTable *table = GetTable(Core);
+
+    if (Num >= 224 || Handler.Function == Null || table == Null) return False;
+
+    AddHandler(table->Heads[Num], Handler);
+
+    return True;
+}
+
+Boolean IdtRemoveHandler(UInt8 Num, InterruptHandler &Handler) {
+    return Num < 224 && RemoveHandler(InterruptHandlers[Num].Head, Handler);
+}
+
+Boolean IdtRemoveHandler(UIntPtr Core, UInt8 Num, InterruptHandler &Handler) {
+    InterruptTable *table = GetTable(Core);
+    return Num < 224 && table != Null && RemoveHandler(table->Heads[Num], Handler);
+}
+
+Void IdtReserveIrq(UInt8 Num) {
+    if (Num < 224) AtomicStore(InterruptHandlers[Num].Used, True);
 }
 
 no_inline static Void IdtSetGate(UInt8 Num, UIntPtr Base, UInt16 Selector, UInt8 Type) {
@@ -124,10 +267,64 @@ no_inline static Void IdtSetGate(UInt8 Num, UIntPtr Base, UInt16 Selector, UInt8
 }
 
 UInt8 IdtAllocIrq(Void) {
-    for (UInt8 i = 0; i < 224; i++) if (!AtomicExchange(InterruptHandlers[i].Used, True)) return i;
+    /* Vectors allocated here are used on all cores, so they need to be free on all the per-core tables as well (and we
+     * need the lock, else some other core might allocate the same vector in the middle of our search). */
+
+    InterruptTable *table;
+
+    AllocLock.Acquire();
+
+    for (UInt8 i = 0; i < 224; i++) {
+        if (AtomicLoad(InterruptHandlers[i].Used)) continue;
+
+        Boolean used = False;
+
+        for (UIntPtr j = 0; !used && (table = GetTable(j)) != Null; j++) used = table->Used[i];
+
+        if (!used) {
+            AtomicStore(InterruptHandlers[i].Used, True);
+            AllocLock.Release();
+            return i;
+        }
+    }
+
+    AllocLock.Release();
+
     return 0xFF;
 }
 
+UInt8 IdtAllocIrq(UIntPtr Core) {
+    /* Each core has its own set of vectors (which are only used by interrupts targeted at it), so we just need to find
+     * one that is free both on the core itself and globally. */
+
+    InterruptTable *table = GetTable(Core);
+
+    if (table == Null) return 0xFF;
+
+    AllocLock.Acquire();
+
+    for (UInt8 i = 0; i < 224; i++) {
+        if (AtomicLoad(InterruptHandlers[i].Used) || table->Used[i]) continue;
+        table->Used[i] = True;
+        AllocLock.Release();
+        return i;
+    }
+
+    AllocLock.Release();
+
+    return 0xFF;
+}
+
+Void IdtFreeIrq(UIntPtr Core, UInt8 Num) {
+    InterruptTable *table = GetTable(Core);
+
+    if (table == Null || Num >= 224) return;
+
+    AllocLock.Acquire();
+    table->Used[Num] = False;
+    AllocLock.Release();
+}
+
 Void IdtReload(Void) {
     asm volatile("lidt %0" :: "m"(IdtPointer));
 }
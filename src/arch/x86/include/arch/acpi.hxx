@@ -1,13 +1,17 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 16 of 2021 at 09:52 BRT
- * Last edited on July 21 of 2021 at 19:56 BRT */
+ * Last edited on October 20 of 2026 at 10:40 BRT */
 
 #pragma once
 
 #include <arch/desctables.hxx>
 #include <ds/list.hxx>
 #include <sys/acpi.hxx>
+#include <sys/call.hxx>
+#include <sys/rcu.hxx>
+#include <sys/work.hxx>
+#include <sys/sched.hxx>
 
 namespace CHicago {
 
@@ -19,6 +23,15 @@ struct packed CoreInfo {
     UIntPtr Id, LApicId;
     volatile Boolean Status;
     const UInt8 *KernelStack;
+    TimerWheel *Wheel;
+    RunQueue *Queue;
+    Thread *FpuOwner = Null;
+    UInt8 FpuFlags = 0;
+    RcuData *Rcu = Null;
+    InterruptTable *Interrupts = Null;
+    WorkQueue *Work = Null;
+    CallQueue *Calls = Null;
+    UIntPtr FpuFaults = 0;
 };
 
 class IoApic {
@@ -34,9 +47,10 @@ public:
 
     Void Mask(Boolean);
     Void Mask(UInt8, Boolean);
-    Void Set(UInt8, UInt8, UInt8);
+    Void Route(UInt8, UInt8, UInt8, UInt8);
     Void Set(UInt8, UInt8, Boolean, Boolean);
     Void GetInfo(UInt8, UInt8&, Boolean&, Boolean&);
+    UInt8 GetDestination(UInt8);
 
     [[nodiscard]] volatile UInt32 &GetRegister(UIntPtr Off) {
         *reinterpret_cast<volatile UInt32*>(Address) = Off;
@@ -64,15 +78,20 @@ public:
     static Void Initialize(const Madt*);
     static Void SetupLApic(Void);
 
+    static Void InitializeTimer(Void);
+    static Void SetupTimer(Void);
+    static Void ArmTimer(UInt64);
+
     static Void Free(UInt8);
     static Int16 Alloc(Void);
     static Boolean Alloc(UInt8);
 
     static Void Mask(Boolean);
     static Void Mask(UInt8, Boolean);
-    static Void Set(UInt8, UInt8, UInt8);
+    static Void Route(UInt8, UInt8, UInt8, UInt8);
     static Void Set(UInt8, UInt8, Boolean, Boolean);
     static Void GetInfo(UInt8, UInt8&, Boolean&, Boolean&);
+    static UInt8 GetDestination(UInt8);
 
     static UInt64 ReadLApicRegister(UIntPtr Off) {
         return !LApicAddress ? ReadMsr(0x800 + (Off >> 4)) : *reinterpret_cast<volatile UInt32*>(LApicAddress + Off);
@@ -83,14 +102,19 @@ public:
         else *reinterpret_cast<volatile UInt32*>(LApicAddress + Off) = Value;
     }
 
-    static UInt8 GetLApicId(Void) {
+    static UInt32 GetLApicId(Void) {
         return !LApicAddress ? ReadLApicRegister(0x20) : ReadLApicRegister(0x20) >> 24;
     }
 
     [[nodiscard]] static Boolean IsInitialized(Void) { return Initialized; }
     [[nodiscard]] static UIntPtr GetLApicAddress(Void) { return LApicAddress; }
+    [[nodiscard]] static Boolean HasTscDeadline(Void) { return TscDeadline; }
+    [[nodiscard]] static Boolean IsTscInvariant(Void) { return TscInvariant; }
+    [[nodiscard]] static UInt64 GetTscFrequency(Void) { return TscFrequency; }
+    [[nodiscard]] static UInt64 GetTimerFrequency(Void) { return TimerFrequency; }
 private:
-    static Boolean Initialized;
+    static Boolean Initialized, TscDeadline, TscInvariant;
+    static UInt64 TscFrequency, TimerFrequency;
     static List<IoApic> IoApics;
     static UIntPtr LApicAddress;
 };
@@ -107,18 +131,13 @@ public:
         UInt8 Protection;
     };
 
-    struct Comparator {
-        UIntPtr Id;
-        Boolean Used;
-        Void (*Handler)(Void*);
-    };
-
     struct ComparatorGroup {
         UInt8 Irq;
-        List<Comparator> Comparators;
+        List<UInt8> Comparators;
     };
 
     static Void Initialize(const Header*);
+    static Void Arm(UInt64);
 
     [[nodiscard]] static UInt64 ReadRegister(UIntPtr Off) {
 #ifdef __i386__
@@ -144,9 +163,11 @@ public:
     [[nodiscard]] static UIntPtr GetMinTicks(Void) { return MinTicks; }
     [[nodiscard]] static UInt64 GetFrequency(Void) { return Frequency; }
     [[nodiscard]] static Boolean IsInitialized(Void) { return Initialized; }
+    [[nodiscard]] static UInt8 GetEventComparator(Void) { return EventComparator; }
 private:
     static UInt64 Frequency;
     static Boolean Initialized;
+    static UInt8 EventComparator;
     static UIntPtr Address, MinTicks;
     static List<ComparatorGroup> Groups;
 };
@@ -157,6 +178,7 @@ public:
 
     static Void SendIpi(UInt8, UInt32, UInt16);
     static Void SendTlbShootdown(UIntPtr, UIntPtr);
+    static Void SyncTsc(const CoreInfo&, Boolean);
 
     [[nodiscard]] static CoreInfo &GetCurrentCore(Void) {
 #ifdef __i386__
@@ -168,13 +190,45 @@ public:
     }
 
     [[nodiscard]] static auto &GetCoreList(Void) { return CoreList; }
-    [[nodiscard]] static UIntPtr GetTlbShootdownSize(Void) { return TlbShootdownSize; }
-    [[nodiscard]] static UIntPtr GetTlbShootdownAddress(Void) { return TlbShootdownAddress; }
 private:
-    static Void TlbShootdownHandler(Registers&);
+    static Boolean AddCore(UInt32);
+    static Void TlbShootdownHandler(Void*);
 
     static List<CoreInfo> CoreList;
-    static UIntPtr TlbShootdownAddress, TlbShootdownSize, TlbShootdownLeft;
+    static volatile UIntPtr TscSyncCore;
+    static volatile UInt32 TscSyncState;
+    static volatile UInt64 TscSyncValue;
+};
+
+/* Device interrupts (IOAPIC pins and MSI/MSI-X messages) can be targeted at any core, using the per-core vectors of
+ * said core; if the caller doesn't care about which core handles the interrupt, we distribute them in a round-robin
+ * fashion. Only cores with 8-bit LAPIC ids can be targeted (as that's all the IOAPIC/MSI destination field has, unless
+ * we had interrupt remapping). MSI-X uses the same message format as MSI (one per table entry), so AllocateMsi can be
+ * used for both. */
+
+#define IRQ_ANY_CORE UINTPTR_MAX
+
+struct MsiMessage {
+    UInt64 Address;
+    UInt32 Data;
+};
+
+class Irq {
+public:
+    static Boolean Allocate(UIntPtr&, UInt8&);
+    static Void Free(UIntPtr, UInt8);
+
+    static Boolean Route(UInt8, InterruptHandler&, UIntPtr = IRQ_ANY_CORE);
+    static Boolean Unroute(UInt8, InterruptHandler&);
+
+    static Boolean ComposeMsi(UIntPtr, UInt8, Boolean, MsiMessage&);
+    static Boolean AllocateMsi(InterruptHandler&, MsiMessage&, UIntPtr = IRQ_ANY_CORE);
+    static Boolean FreeMsi(const MsiMessage&, InterruptHandler&);
+private:
+    static Boolean GetDestination(UIntPtr, UInt8&);
+    static UIntPtr GetCore(UInt8);
+
+    static UIntPtr NextCore;
 };
 
 }
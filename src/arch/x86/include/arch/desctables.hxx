@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on June 29 of 2020, at 09:47 BRT
- * Last edited on July 21 of 2021, at 16:29 BRT */
+ * Last edited on October 19 of 2026, at 16:55 BRT */
 
 #pragma once
 
@@ -10,11 +10,11 @@
 namespace CHicago {
 
 struct packed Registers {
-    UIntPtr Ss, Gs, Fs, Es, Ds, Di, Si,
+    UIntPtr Ss, Gs, Fs, Es, Ds,
 #ifndef __i386__
             R15, R14, R13, R12, R11, R10, R9, R8,
 #endif
-            Bp, Sp, Bx, Dx, Cx, Ax, IntNum, ErrCode, Ip, Cs, Flags, Sp2, Ss2;
+            Di, Si, Bp, Sp, Bx, Dx, Cx, Ax, IntNum, ErrCode, Ip, Cs, Flags, Sp2, Ss2;
 };
 
 struct packed TssEntry {
@@ -52,7 +52,27 @@ private:
     DescTablePointer Pointer {};
 };
 
-typedef Void (*InterruptHandlerFunc)(Registers&);
+typedef Void (*InterruptHandlerFunc)(Registers&, Void*);
+
+/* Interrupt handlers are owned by whoever registered them (the IDT code only links them into the list of their vector,
+ * so adding/removing them never allocates anything), and multiple handlers can share the same vector (each one with
+ * its own context pointer). */
+
+struct InterruptHandler {
+    InterruptHandler *Next;
+    InterruptHandlerFunc Function;
+    Void *Context;
+};
+
+/* Besides the global vectors (used for the same thing on every core, like IPIs and legacy IRQs), each core has its own
+ * set of vectors (so we're not limited to 224 device interrupts in total, and each device interrupt can be targeted
+ * at any core). */
+
+struct InterruptTable {
+    Boolean Used[224];
+    InterruptHandler *volatile Heads[224];
+    UIntPtr Depth;
+};
 
 extern "C" UIntPtr IdtDefaultHandlers[256];
 
@@ -75,8 +95,22 @@ static inline Void WriteMsr(UInt32 Num, UInt64 Value) {
 #endif
 }
 
-Void IdtSetHandler(UInt8, InterruptHandlerFunc);
+static inline UInt64 ReadTsc(Void) {
+#ifdef __i386__
+    UInt64 val; asm volatile("rdtsc" : "=A"(val)); return val;
+#else
+    UInt32 eax, edx; asm volatile("rdtsc" : "=a"(eax), "=d"(edx)); return eax | ((UInt64)edx << 32);
+#endif
+}
+
+Boolean IdtAddHandler(UInt8, InterruptHandler&);
+Boolean IdtAddHandler(UIntPtr, UInt8, InterruptHandler&);
+Boolean IdtRemoveHandler(UInt8, InterruptHandler&);
+Boolean IdtRemoveHandler(UIntPtr, UInt8, InterruptHandler&);
+Void IdtReserveIrq(UInt8);
 UInt8 IdtAllocIrq(Void);
+UInt8 IdtAllocIrq(UIntPtr);
+Void IdtFreeIrq(UIntPtr, UInt8);
 Void IdtReload(Void);
 Void IdtInit(Void);
 
@@ -0,0 +1,50 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 13:30 BRT
+ * Last edited on October 20 of 2026, at 10:00 BRT */
+
+#pragma once
+
+#include <arch/desctables.hxx>
+#include <sys/sched.hxx>
+
+/* Per-core FPU flags: the registers have changes that aren't saved into the owner's area yet (DIRTY), some interrupt
+ * handler clobbered the registers (KERNEL), we're inside an interrupt handler (INTERRUPT), and we set CR0.TS when
+ * entering the interrupt handler, so we need to clear it again on the way out (RESUME). */
+
+#define FPU_DIRTY 0x01
+#define FPU_KERNEL 0x02
+#define FPU_INTERRUPT 0x04
+#define FPU_RESUME 0x08
+
+namespace CHicago {
+
+class Fpu {
+public:
+    enum class Mode { FxSave, XSave, XSaveOpt, XSaveS };
+
+    static Void Initialize(Void);
+    static Void InitializeCore(Void);
+
+    static Void *Allocate(Void);
+    static Void Free(Void*);
+    static Void SetOwner(Thread&);
+    static Void Switch(Thread&, Thread&);
+
+    static Boolean HandleFault(Void);
+    static Void EnterInterrupt(Void);
+    static Void ExitInterrupt(Void);
+    static Void TakeOver(Void);
+
+    [[nodiscard]] static Mode GetMode(Void) { return CurrentMode; }
+    [[nodiscard]] static UIntPtr GetSize(Void) { return Size; }
+private:
+    static Void Save(Void*);
+    static Void Restore(Void*);
+
+    static Mode CurrentMode;
+    static UIntPtr Size;
+    static UInt64 Features;
+};
+
+}
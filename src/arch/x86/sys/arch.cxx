@@ -1,19 +1,35 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 06 of 2021, at 12:47 BRT
- * Last edited on July 21 of 2021, at 19:55 BRT */
+ * Last edited on October 20 of 2026, at 10:50 BRT */
 
 #include <arch/acpi.hxx>
+#include <arch/fpu.hxx>
 #include <sys/panic.hxx>
+#include <util/memory.hxx>
 
 using namespace CHicago;
 
 Gdt BspGdt {};
 
-static Void Handler(Registers&) { Arch::Halt(True); }
+/* Owned by the BSP (core 0): that's where the HPET interrupt is routed to, and when we fall back to the HPET, every
+ * core shares this wheel. */
+
+TimerWheel BspWheel { 0 };
+RunQueue BspQueue {};
+RcuData BspRcu {};
+WorkQueue BspWork {};
+CallQueue BspCalls {};
+
+extern InterruptHandler WorkIrq, CallIrq;
+
+static Boolean MwaitSupported = False;
+static UInt32 MwaitHint = 0;
+static volatile Boolean MwaitDummy = False;
 
 Void Acpi::InitializeArch(const BootInfo &Info) {
-    /* APIC (LAPIC and IOAPICs) -> HPET -> SMP (HPET depends on the IOAPIC, SMP depends on both APIC and HPET). */
+    /* APIC (LAPIC and IOAPICs) -> HPET -> LAPIC timer -> SMP (HPET depends on the IOAPIC, the LAPIC timer is
+     * calibrated using the HPET, SMP depends on everything else). */
 
     UIntPtr size1, size2;
     auto madt = reinterpret_cast<const Apic::Madt*>(GetHeader("APIC", size1));
@@ -22,6 +38,7 @@ Void Acpi::InitializeArch(const BootInfo &Info) {
     ASSERT(madt != Null && hpet != Null);
     Apic::Initialize(madt);
     Hpet::Initialize(hpet);
+    Apic::InitializeTimer();
     Smp::Initialize(Info, madt);
 
     VirtMem::Unmap(reinterpret_cast<UIntPtr>(madt) & ~PAGE_MASK, size1);
@@ -38,8 +55,90 @@ Void Arch::Initialize(const BootInfo&) {
     Debug.Write("{}initialized the global descriptor table{}\n", SetForeground { 0xFF00FF00 }, RestoreForeground{});
 
     IdtInit();
-    IdtSetHandler(0xDE, Handler);
+    IdtAddHandler(0xDD, CallIrq);
+    IdtAddHandler(0xD9, WorkIrq);
     Debug.Write("{}initialized the interrupt descriptor table{}\n", SetForeground { 0xFF00FF00 }, RestoreForeground{});
+
+    /* The FPU state of each thread is saved/restored lazily (on the first use after a switch), the size and the
+     * instructions that we use depend on what the processor supports. */
+
+    Fpu::Initialize();
+
+    /* The memory primitives (CopyMemory and friends) use the widest vectors that got enabled above. */
+
+    Memory::Initialize();
+    Debug.Write("{}using {} for the memory primitives{}{}\n", SetForeground { 0xFF00FF00 },
+                Memory::GetFunctions().Name, Memory::GetFunctions().Erms ? " (with rep movsb/stosb)" : "",
+                RestoreForeground{});
+
+    if (Memory::GetNonTemporalThreshold() != UINTPTR_MAX)
+        Debug.Write("{}using non-temporal stores for copies/sets of {} KiB or more{}\n", SetForeground { 0xFF00FF00 },
+                    Memory::GetNonTemporalThreshold() >> 10, RestoreForeground{});
+
+    /* Idle cores use MONITOR/MWAIT if we have it (and if it can be woken up by interrupts even while they are
+     * disabled), going into the deepest C-state that the processor enumerates. If the LAPIC timer isn't always running
+     * (no ARAT), anything deeper than C1 might stop it, so we can't go further than that. */
+
+    UInt32 max, ax, bx, cx, dx;
+
+    asm volatile("cpuid" : "=a"(max), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(1));
+
+    if (max < 5 || !(cx & 0x08)) return;
+
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(5));
+    if ((cx & 0x03) != 0x03) return;
+
+    MwaitSupported = True;
+
+    if (max >= 6) {
+        UInt32 subs = dx;
+        asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(6));
+
+        for (UInt32 i = 7; (ax & 0x04) && i > 0; i--) {
+            if ((subs >> (i * 4)) & 0x0F) {
+                MwaitHint = ((i - 1) << 4) | (((subs >> (i * 4)) & 0x0F) - 1);
+                break;
+            }
+        }
+    }
+
+    Debug.Write("{}using MWAIT for idle cores (hint = 0x{:0:16}){}\n", SetForeground { 0xFF00FF00 }, MwaitHint,
+                RestoreForeground{});
+}
+
+Boolean Arch::CanIdle(Void) {
+    /* We can only sleep if something is going to wake us up: interrupts need to be enabled, and we need a timer that
+     * can interrupt this core (the HPET only interrupts one core, but with MWAIT, the write to the flag that we're
+     * waiting on is enough to wake us up). */
+
+    UIntPtr flags;
+#ifdef __i386__
+    asm volatile("pushfl; pop %0" : "=r"(flags));
+#else
+    asm volatile("pushfq; pop %0" : "=r"(flags));
+#endif
+
+    if (!(flags & 0x200)) return False;
+    else if (Apic::GetTimerFrequency()) return True;
+
+    return Hpet::IsInitialized() && Hpet::GetEventComparator() != 0xFF && (!GetCoreId() || MwaitSupported);
+}
+
+Void Arch::WaitForInterrupt(const volatile Boolean *Flag) {
+    /* This should be called with interrupts disabled (and it returns with them disabled), but it sleeps with them
+     * enabled (so that the interrupt that woke us up gets handled before we return). For MWAIT, bit 0 of ECX makes
+     * interrupts wake us up even while they're disabled, and we need to recheck the flag after arming the monitor (it
+     * might have been set right before that). */
+
+    if (!MwaitSupported) {
+        asm volatile("sti; hlt; cli" ::: "memory");
+        return;
+    }
+
+    asm volatile("monitor" :: "a"(Flag != Null ? Flag : &MwaitDummy), "c"(0), "d"(0) : "memory");
+    if (Flag != Null && AtomicLoad(*Flag)) return;
+    asm volatile("mwait; sti; nop; cli" :: "a"(MwaitHint), "c"(1) : "memory");
 }
 
 Void Arch::EnterPanicState(Void) {
@@ -47,7 +146,7 @@ Void Arch::EnterPanicState(Void) {
 
     static SpinLock lock;
     lock.Acquire();
-    Smp::SendIpi(2, 0, 0xFE);
+    Call::StopOthers();
 }
 
 no_return Void Arch::Halt(Boolean Full) {
@@ -0,0 +1,32 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 17:30 BRT
+ * Last edited on October 19 of 2026, at 17:30 BRT */
+
+#include <arch/acpi.hxx>
+#include <sys/call.hxx>
+
+using namespace CHicago;
+
+extern CallQueue BspCalls;
+
+static Void Handler(Registers&, Void*) {
+    Call::Process();
+}
+
+InterruptHandler CallIrq { Null, Handler, Null };
+
+CallQueue &Call::GetQueue(Void) {
+    return Smp::GetCoreList().GetLength() <= 1 ? BspCalls : *Smp::GetCurrentCore().Calls;
+}
+
+CallQueue *Call::GetQueue(UIntPtr Id) {
+    auto &list = Smp::GetCoreList();
+    return list.GetLength() <= 1 ? (!Id ? &BspCalls : Null) : (Id < list.GetLength() ? list[Id].Calls : Null);
+}
+
+Void Call::Notify(UIntPtr Id) {
+    /* Vector 0xFD is the cross-core call IPI. */
+
+    Smp::SendIpi(0, Smp::GetCoreList()[Id].LApicId, 0xFD);
+}
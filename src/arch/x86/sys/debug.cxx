@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 20 of 2021, at 19:49 BRT
- * Last edited on July 20 of 2021, at 20:07 BRT */
+ * Last edited on October 20 of 2026, at 00:50 BRT */
 
 #include <arch/port.hxx>
 #include <sys/arch.hxx>
@@ -53,6 +53,18 @@ Void Arch::WriteDebug(Char Data) {
     Port::OutByte(0x3F8, Data);
 }
 
+Void Arch::WriteDebug(const Char *Data, UIntPtr Length) {
+    /* InitializeDebug enables the (16 bytes) FIFO, and the THR empty bit means that the whole FIFO is empty, so we
+     * only need to wait once for every 16 characters. */
+
+    if (!Initialized) return;
+
+    while (Length) {
+        while (!(Port::InByte(0x3FD) & 0x20)) ARCH_PAUSE();
+        for (UIntPtr i = 0; i < 16 && Length; i++, Length--) Port::OutByte(0x3F8, *Data++);
+    }
+}
+
 Void Arch::ClearDebug(UInt32 Color) {
     /* For setting the background and foreground colors (and clearing the debug terminal), we use ANSI escape codes. */
 
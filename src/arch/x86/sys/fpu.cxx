@@ -0,0 +1,283 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 13:30 BRT
+ * Last edited on October 20 of 2026, at 10:00 BRT */
+
+#include <arch/acpi.hxx>
+#include <arch/fpu.hxx>
+#include <sys/mm.hxx>
+#include <sys/panic.hxx>
+
+using namespace CHicago;
+
+#ifdef __i386__
+#define FPU_INSTRUCTION(x) x " (%0)"
+#else
+#define FPU_INSTRUCTION(x) x "64 (%0)"
+#endif
+
+Fpu::Mode Fpu::CurrentMode = Fpu::Mode::FxSave;
+UIntPtr Fpu::Size = 512;
+UInt64 Fpu::Features = 0;
+
+/* Each state area has a small header (right before it, so that the area itself is 64-byte aligned) saying in which
+ * core the area was last loaded into the registers. */
+
+static inline UIntPtr &GetLoadedCore(Void *Area) {
+    return *reinterpret_cast<UIntPtr*>(static_cast<UInt8*>(Area) - 64);
+}
+
+static inline Boolean IsTsSet(Void) {
+    UIntPtr cr0; asm volatile("mov %%cr0, %0" : "=r"(cr0));
+    return cr0 & 0x08;
+}
+
+static inline Void SetTs(Void) {
+    UIntPtr cr0; asm volatile("mov %%cr0, %0" : "=r"(cr0));
+    asm volatile("mov %0, %%cr0" :: "r"(cr0 | 0x08) : "memory");
+}
+
+static inline Void ClearTs(Void) {
+    asm volatile("clts" ::: "memory");
+}
+
+static inline CoreInfo *GetCore(Void) {
+    /* We only start tracking the FPU state after the scheduler is running on this core (before that, there is only a
+     * single context, so there is nothing to save). */
+
+    if (!Smp::GetCoreList().GetLength()) return Null;
+    auto &core = Smp::GetCurrentCore();
+    return core.Queue == Null || core.Queue->Current == Null ? Null : &core;
+}
+
+Void Fpu::Initialize(Void) {
+    /* Use the best save instruction that we have: XSAVES (compacted format, with both the init and the modified
+     * optimizations), XSAVEOPT (standard format, same optimizations), XSAVE, or if we don't even have XSAVE, FXSAVE.
+     * The size of the area depends on what is enabled on XCR0 (and the format), so before anything else, we also enable
+     * the AVX-512 state (opmask + both halves of the ZMM registers) if the processor has it (the loader only enables
+     * x87/SSE/AVX). */
+
+    UInt32 ax, bx, cx, dx, max;
+
+    asm volatile("cpuid" : "=a"(max), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(1));
+
+    if ((cx & 0xC000000) == 0xC000000) {
+        asm volatile("xgetbv" : "=a"(ax), "=d"(dx) : "c"(0));
+        Features = ax | (static_cast<UInt64>(dx) << 32);
+
+        if (max >= 0x0D && (Features & 0x06) == 0x06) {
+            UInt32 bx7 = 0;
+
+            asm volatile("cpuid" : "=a"(ax), "=b"(bx7), "=c"(cx), "=d"(dx) : "a"(7), "c"(0));
+            asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x0D), "c"(0));
+
+            if ((bx7 & 0x10000) && (ax & 0xE0) == 0xE0) {
+                Features |= 0xE0;
+                InitializeCore();
+            }
+        }
+
+        asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x0D), "c"(1));
+
+        if (ax & 0x08) {
+            WriteMsr(0xDA0, 0);
+            CurrentMode = Mode::XSaveS;
+            Size = bx;
+        } else {
+            CurrentMode = ax & 0x01 ? Mode::XSaveOpt : Mode::XSave;
+            asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0x0D), "c"(0));
+            Size = bx;
+        }
+    }
+
+    Debug.Write("{}using {} for saving the FPU state ({} bytes per thread){}\n", SetForeground { 0xFF00FF00 },
+                CurrentMode == Mode::XSaveS ? "XSAVES" : (CurrentMode == Mode::XSaveOpt ? "XSAVEOPT" :
+                (CurrentMode == Mode::XSave ? "XSAVE" : "FXSAVE")), Size, RestoreForeground{});
+}
+
+Void Fpu::InitializeCore(Void) {
+    /* The APs need to enable the same state components as the BSP (else the area sizes/formats wouldn't match). */
+
+    if (Features) asm volatile("xsetbv" :: "a"(static_cast<UInt32>(Features)), "d"(static_cast<UInt32>(Features >> 32)),
+                               "c"(0));
+}
+
+Void *Fpu::Allocate(Void) {
+    /* New areas start on the init state (which for XSAVE is just XSTATE_BV=0), but the control words are loaded
+     * either way, so make sure that all the exceptions are masked. XRSTORS also requires the compacted format bit. */
+
+    auto raw = static_cast<UInt8*>(Heap::Allocate(Size + 64, 64));
+    if (raw == Null) return Null;
+
+    UInt8 *area = raw + 64;
+
+    SetMemory(raw, 0, Size + 64);
+    GetLoadedCore(area) = UINTPTR_MAX;
+    *reinterpret_cast<UInt16*>(area) = 0x37F;
+    *reinterpret_cast<UInt32*>(area + 24) = 0x1F80;
+
+    if (CurrentMode == Mode::XSaveS) *reinterpret_cast<UInt64*>(area + 520) = (1ull << 63) | Features;
+
+    return area;
+}
+
+Void Fpu::Free(Void *Area) {
+    if (Area != Null) Heap::Free(static_cast<UInt8*>(Area) - 64);
+}
+
+Void Fpu::SetOwner(Thread &Target) {
+    /* Used for the boot thread of each core (whose state is already in the registers). */
+
+    auto &core = Smp::GetCurrentCore();
+
+    if (Target.FpuState == Null) return;
+
+    GetLoadedCore(Target.FpuState) = core.Id;
+    core.FpuOwner = &Target;
+    core.FpuFlags = FPU_DIRTY;
+}
+
+Void Fpu::Save(Void *Area) {
+    switch (CurrentMode) {
+    case Mode::FxSave: asm volatile(FPU_INSTRUCTION("fxsave") :: "r"(Area) : "memory"); break;
+    case Mode::XSave: asm volatile(FPU_INSTRUCTION("xsave") :: "r"(Area), "a"(-1), "d"(-1) : "memory"); break;
+    case Mode::XSaveOpt: asm volatile(FPU_INSTRUCTION("xsaveopt") :: "r"(Area), "a"(-1), "d"(-1) : "memory"); break;
+    case Mode::XSaveS: asm volatile(FPU_INSTRUCTION("xsaves") :: "r"(Area), "a"(-1), "d"(-1) : "memory"); break;
+    }
+}
+
+Void Fpu::Restore(Void *Area) {
+    switch (CurrentMode) {
+    case Mode::FxSave: asm volatile(FPU_INSTRUCTION("fxrstor") :: "r"(Area) : "memory"); break;
+    case Mode::XSaveS: asm volatile(FPU_INSTRUCTION("xrstors") :: "r"(Area), "a"(-1), "d"(-1) : "memory"); break;
+    default: asm volatile(FPU_INSTRUCTION("xrstor") :: "r"(Area), "a"(-1), "d"(-1) : "memory"); break;
+    }
+}
+
+Void Fpu::TakeOver(Void) {
+    /* Some interrupt handler wants to use the FPU: save whatever the interrupted thread had on the registers (if it
+     * wasn't saved yet), and give the registers to the handler; the owner will have to restore its state the next
+     * time it uses the FPU. */
+
+    auto &core = Smp::GetCurrentCore();
+
+    ClearTs();
+
+    if (core.FpuOwner != Null && (core.FpuFlags & FPU_DIRTY)) Save(core.FpuOwner->FpuState);
+
+    core.FpuOwner = Null;
+    core.FpuFlags = (core.FpuFlags & ~(FPU_DIRTY | FPU_RESUME)) | FPU_KERNEL;
+}
+
+Void Fpu::Switch(Thread &From, Thread &To) {
+    /* Called by the scheduler (inside of the interrupt handler) when switching threads: if the old thread touched the
+     * FPU, save its state (XSAVEOPT/XSAVES skip whatever wasn't modified), and if the registers still have the state
+     * of the new thread (it was the last one to use the FPU on this core), we don't even need to trap on its first
+     * use, else, CR0.TS stays set (and HandleFault restores the state when needed). */
+
+    auto core = GetCore();
+
+    if (core == Null) return;
+    else if (core->FpuOwner == &From) {
+        if (From.State == ThreadState::Dead) core->FpuOwner = Null;
+        else if (core->FpuFlags & FPU_DIRTY) {
+            ClearTs();
+            Save(From.FpuState);
+        }
+    }
+
+    core->FpuFlags &= ~(FPU_DIRTY | FPU_KERNEL | FPU_RESUME);
+
+    if (To.FpuState != Null && core->FpuOwner == &To && GetLoadedCore(To.FpuState) == core->Id)
+        core->FpuFlags |= FPU_DIRTY | FPU_RESUME;
+}
+
+Boolean Fpu::HandleFault(Void) {
+    /* Device-not-available exception (we had CR0.TS set, and someone used the FPU). Inside interrupt handlers, we just
+     * give the registers to the handler, else, restore the state of the current thread (unless it's already there). */
+
+    auto core = GetCore();
+
+    if (core == Null || !IsTsSet()) return False;
+
+    core->FpuFaults++;
+
+    if (core->FpuFlags & FPU_INTERRUPT) {
+        TakeOver();
+        return True;
+    }
+
+    Thread *cur = core->Queue->Current;
+
+    if (cur->FpuState == Null) return False;
+
+    ClearTs();
+
+    if (core->FpuOwner != cur || GetLoadedCore(cur->FpuState) != core->Id) {
+        if (core->FpuOwner != Null && (core->FpuFlags & FPU_DIRTY)) Save(core->FpuOwner->FpuState);
+        Restore(cur->FpuState);
+        GetLoadedCore(cur->FpuState) = core->Id;
+        core->FpuOwner = cur;
+    }
+
+    core->FpuFlags |= FPU_DIRTY;
+
+    return True;
+}
+
+Void Fpu::EnterInterrupt(Void) {
+    /* If the interrupted thread has its (unsaved) state on the registers, set CR0.TS, so that the handler traps if it
+     * tries to use the FPU, instead of silently clobbering the state. */
+
+    auto core = GetCore();
+
+    if (core == Null) return;
+
+    core->FpuFlags |= FPU_INTERRUPT;
+
+    if (!IsTsSet()) {
+        SetTs();
+        core->FpuFlags |= FPU_RESUME;
+    }
+}
+
+Void Fpu::ExitInterrupt(Void) {
+    /* Only clear CR0.TS if the registers still have the state of the thread that we're returning to. */
+
+    auto core = GetCore();
+
+    if (core == Null) return;
+
+    UInt8 flags = core->FpuFlags;
+    core->FpuFlags &= ~(FPU_INTERRUPT | FPU_KERNEL | FPU_RESUME);
+
+    if ((flags & FPU_RESUME) && !(flags & FPU_KERNEL)) ClearTs();
+    else if (!IsTsSet()) SetTs();
+}
+
+Void Arch::BeginFpu(Void) {
+    /* Threads can use the FPU whenever they want (their state is managed lazily), but interrupt handlers need to
+     * call this before touching it (so that we don't need to take the fault, that is). */
+
+    auto core = GetCore();
+    if (core != Null && (core->FpuFlags & FPU_INTERRUPT) && !(core->FpuFlags & FPU_KERNEL)) Fpu::TakeOver();
+}
+
+UIntPtr Arch::GetFpuFaultCount(Void) {
+    /* Amount of #NM faults that we handled (on all cores), that is, how many times we had to restore the FPU state
+     * of some thread (or save it for an interrupt handler). This should stay low, as the memory primitives never touch
+     * the FPU unless it's already usable. */
+
+    UIntPtr res = 0;
+    for (auto &core : Smp::GetCoreList()) res += core.FpuFaults;
+    return res;
+}
+
+Void Arch::EndFpu(Void) {
+    /* Trap again if the handler touches the FPU after saying that it was done with it (the registers only go back
+     * to the interrupted thread after it restores its state). */
+
+    auto core = GetCore();
+    if (core != Null && (core->FpuFlags & FPU_INTERRUPT) && (core->FpuFlags & FPU_KERNEL)) SetTs();
+}
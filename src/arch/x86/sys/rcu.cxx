@@ -0,0 +1,20 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 15:10 BRT
+ * Last edited on October 19 of 2026, at 15:10 BRT */
+
+#include <arch/acpi.hxx>
+#include <sys/rcu.hxx>
+
+using namespace CHicago;
+
+extern RcuData BspRcu;
+
+RcuData &Rcu::GetData(Void) {
+    return Smp::GetCoreList().GetLength() <= 1 ? BspRcu : *Smp::GetCurrentCore().Rcu;
+}
+
+RcuData *Rcu::GetData(UIntPtr Id) {
+    auto &list = Smp::GetCoreList();
+    return list.GetLength() <= 1 ? (!Id ? &BspRcu : Null) : (Id < list.GetLength() ? list[Id].Rcu : Null);
+}
@@ -0,0 +1,88 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 12:40 BRT
+ * Last edited on October 19 of 2026, at 15:45 BRT */
+
+#include <arch/acpi.hxx>
+#include <arch/fpu.hxx>
+#include <sys/sched.hxx>
+
+using namespace CHicago;
+
+extern RunQueue BspQueue;
+
+static Void RescheduleHandler(Registers&, Void*) {
+    /* Nothing to do here, IdtDefaultHandler always calls Scheduler::Schedule before returning. */
+}
+
+static InterruptHandler YieldIrq { Null, RescheduleHandler, Null }, WakeIrq { Null, RescheduleHandler, Null };
+
+Void Scheduler::InitializeArch(Thread &Boot) {
+    /* Vector 0xFB is what Yield/Block/Exit use (it's a software interrupt, so IdtDefaultHandler knows that it shouldn't
+     * send an EOI for it), and 0xFA is the IPI that other cores send to kick us out of the idle thread. The FPU state
+     * of the boot thread is whatever is on the registers right now. */
+
+    IdtAddHandler(0xDB, YieldIrq);
+    IdtAddHandler(0xDA, WakeIrq);
+    Fpu::SetOwner(Boot);
+}
+
+RunQueue &Scheduler::GetQueue(Void) {
+    return Smp::GetCoreList().GetLength() <= 1 ? BspQueue : *Smp::GetCurrentCore().Queue;
+}
+
+RunQueue *Scheduler::GetQueue(UIntPtr Id) {
+    auto &list = Smp::GetCoreList();
+    return list.GetLength() <= 1 ? (!Id ? &BspQueue : Null) : (Id < list.GetLength() ? list[Id].Queue : Null);
+}
+
+Void *Scheduler::CreateFrame(Thread &Target) {
+    /* The initial context is a fake interrupt frame at the top of the stack, which "returns" into Scheduler::Start.
+     * On x86-32, iret doesn't pop the stack pointer (we're not changing privilege levels), so the thread starts with
+     * the stack right after the frame (and Sp2 works as the return address of Start). Either way, the stack should be
+     * aligned just like if Start was called. */
+
+    UIntPtr sp = (reinterpret_cast<UIntPtr>(Target.Stack) + SCHED_STACK_SIZE - 16) & ~0x0F;
+#ifdef __i386__
+    auto frame = reinterpret_cast<Registers*>(sp + 4 - sizeof(Registers));
+#else
+    auto frame = reinterpret_cast<Registers*>((sp - 8 - sizeof(Registers)) & ~0x0F);
+#endif
+
+    SetMemory(frame, 0, sizeof(Registers));
+
+    frame->Ss = frame->Ds = frame->Es = 0x10;
+#ifdef __i386__
+    frame->Fs = 0x30;
+    frame->Gs = 0x38;
+#else
+    frame->Sp2 = sp - 8;
+    frame->Ss2 = 0x10;
+#endif
+    frame->Cs = 0x08;
+    frame->Flags = 0x202;
+    frame->Ip = reinterpret_cast<UIntPtr>(Start);
+
+    return frame;
+}
+
+Void *Scheduler::CreateFpuState(Void) {
+    return Fpu::Allocate();
+}
+
+Void Scheduler::FreeFpuState(Void *State) {
+    Fpu::Free(State);
+}
+
+Void Scheduler::Switch(Thread &From, Thread &To) {
+    Fpu::Switch(From, To);
+}
+
+Void Scheduler::Trigger(Void) {
+    asm volatile("int $0xFB" ::: "memory");
+}
+
+Void Scheduler::Wake(UIntPtr Id) {
+    auto &list = Smp::GetCoreList();
+    if (Id < list.GetLength() && AtomicLoad(list[Id].Status)) Smp::SendIpi(0, list[Id].LApicId, 0xFA);
+}
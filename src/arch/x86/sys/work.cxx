@@ -0,0 +1,27 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 16:55 BRT
+ * Last edited on October 19 of 2026, at 16:55 BRT */
+
+#include <arch/acpi.hxx>
+#include <sys/work.hxx>
+
+using namespace CHicago;
+
+extern WorkQueue BspWork;
+
+static Void Handler(Registers&, Void*) {
+    /* Nothing to do here, IdtDefaultHandler always calls Work::Run before returning. */
+}
+
+InterruptHandler WorkIrq { Null, Handler, Null };
+
+WorkQueue &Work::GetQueue(Void) {
+    return Smp::GetCoreList().GetLength() <= 1 ? BspWork : *Smp::GetCurrentCore().Work;
+}
+
+Void Work::Trigger(Void) {
+    /* Vector 0xF9 is the self-IPI that we use for continuing the work that didn't fit into the last pass. */
+
+    Smp::SendIpi(0, Apic::GetLApicId(), 0xF9);
+}
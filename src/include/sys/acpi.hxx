@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 11 of 2021, at 17:50 BRT
- * Last edited on July 21 of 2021 at 12:23 BRT */
+ * Last edited on October 19 of 2026 at 23:55 BRT */
 
 #pragma once
 
@@ -10,7 +10,7 @@
 namespace CHicago {
 
 struct packed BootInfo;
-template<class T> class List;
+template<class K, class V> class HashMap;
 
 class Acpi {
 public:
@@ -63,8 +63,10 @@ public:
     static Void InitializeArch(const BootInfo&);
     static SdtHeader *GetHeader(const Char[4], UIntPtr&);
 private:
-    struct CacheEntry { UIntPtr Size; UInt64 Address; Char Signature[4]; };
-    static List<CacheEntry> Cache;
+    /* The cache is keyed by the signature (read as an UInt32). */
+
+    struct CacheEntry { UIntPtr Size; UInt64 Address; };
+    static HashMap<UInt32, CacheEntry> Cache;
 };
 
 }
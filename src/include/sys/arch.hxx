@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 06 of 2021, at 12:46 BRT
- * Last edited on July 21 of 2021 at 19:00 BRT */
+ * Last edited on October 20 of 2026 at 10:00 BRT */
 
 #pragma once
 
@@ -21,19 +21,20 @@ public:
     static Void FinishCore(Void);
 
     static Void WriteDebug(Char);
+    static Void WriteDebug(const Char*, UIntPtr);
     static Void ClearDebug(UInt32);
     static Void SetDebugBackground(UInt32);
     static Void SetDebugForeground(UInt32);
 
+    static Boolean CanIdle(Void);
+    static Void WaitForInterrupt(const volatile Boolean* = Null);
+
+    static Void BeginFpu(Void);
+    static Void EndFpu(Void);
+    static UIntPtr GetFpuFaultCount(Void);
+
     static Void EnterPanicState(Void);
     static no_return Void Halt(Boolean = False);
 };
 
-class Timer {
-public:
-    static Boolean SetEvent(TimeUnit, UInt64, Void(*)(Void*));
-    static Void Sleep(TimeUnit, UInt64);
-    static UInt64 GetUpTime(TimeUnit);
-};
-
 }
@@ -0,0 +1,30 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 10:00 BRT
+ * Last edited on October 20 of 2026, at 10:00 BRT */
+
+#pragma once
+
+#include <base/types.hxx>
+
+/* How many times each core takes the lock on each round of the lock benchmark, and how many times each thread yields
+ * on the scheduler/FPU benchmark. */
+
+#define BENCH_LOCK_ITERATIONS 200000
+#define BENCH_THREAD_ITERATIONS 2000
+
+namespace CHicago {
+
+/* Boot-time benchmarks, only built (and run, right after the scheduler is up on all cores) when the kernel is built
+ * with BENCHMARK=true, as they keep every core busy (with interrupts disabled) for a while. Run them under QEMU with
+ * different -smp values (or on real hardware) and compare the output. */
+
+class Benchmark {
+public:
+    static Void Run(Void);
+private:
+    static Void RunLocks(Void);
+    static Void RunThreads(Void);
+};
+
+}
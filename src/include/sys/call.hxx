@@ -0,0 +1,56 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 17:30 BRT
+ * Last edited on October 19 of 2026, at 17:30 BRT */
+
+#pragma once
+
+#include <sys/arch.hxx>
+#include <util/lock.hxx>
+
+namespace CHicago {
+
+/* Cross-core function calls: each core has a mailbox (a lock-free stack, just like the incoming list of the deferred
+ * work queues), and an IPI only needs to be sent when the mailbox goes from empty to non-empty (anything queued after
+ * that is picked up by the same IPI). The functions run on the target core, inside the IPI handler (with interrupts
+ * disabled), so they should be short, and they must never block (or make synchronous calls themselves). Requests are
+ * owned by the caller (like the timer events), and Queued only goes back to False after the function returned, so it
+ * also works as the completion flag for asynchronous calls. */
+
+struct CrossCall {
+    CrossCall *Next;
+    volatile Boolean Queued;
+    Void (*Function)(Void*);
+    Void *Context;
+    volatile UIntPtr *Left;
+};
+
+/* Besides the mailbox itself, each core has one request for each possible target (used by its own synchronous
+ * calls, which always wait for completion, so one is enough), and a halt request (which other cores use when
+ * panicking, as we can't trust the heap at that point). */
+
+struct CallQueue {
+    CrossCall *volatile Incoming = Null;
+    CrossCall *Requests = Null, Halt {};
+    volatile Boolean Online = False;
+};
+
+class Call {
+public:
+    static Void Initialize(Void);
+
+    static Boolean RunOnCore(CrossCall&, UIntPtr, Void(*)(Void*), Void* = Null);
+    static Boolean RunOnCore(UIntPtr, Void(*)(Void*), Void* = Null);
+    static Void RunOnAll(Void(*)(Void*), Void* = Null, Boolean = True);
+    static Void StopOthers(Void);
+    static Void Process(Void);
+private:
+    static CallQueue &GetQueue(Void);
+    static CallQueue *GetQueue(UIntPtr);
+    static Void Notify(UIntPtr);
+
+    static Boolean Push(CallQueue&, CrossCall&);
+    static Void Wait(volatile UIntPtr&);
+};
+
+}
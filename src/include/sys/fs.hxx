@@ -1,11 +1,12 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 28 of 2021, at 14:01 BRT
- * Last edited on March 06 of 2021 at 21:33 BRT */
+ * Last edited on October 20 of 2026 at 11:30 BRT */
 
 #pragma once
 
-#include <base/string.hxx>
+#include <ds/hashmap.hxx>
+#include <sys/rcu.hxx>
 
 #define OPEN_DIR 0x01
 #define OPEN_READ 0x02
@@ -89,10 +90,25 @@ private:
     String Path;
 };
 
+/* The mount points are keyed by their path (so they can be looked up using just a StringView). */
+
+template<> struct HashKey<MountPoint> {
+    static inline UInt64 GetHash(const MountPoint &Value) { return HashKey<StringView>::GetHash(Value.GetPath()); }
+    static inline UInt64 GetHash(const StringView &Path) { return HashKey<StringView>::GetHash(Path); }
+
+    static inline Boolean Compare(const MountPoint &Left, const MountPoint &Right) {
+        return Left.GetPath().Compare(Right.GetPath());
+    }
+
+    static inline Boolean Compare(const MountPoint &Left, const StringView &Right) {
+        return Left.GetPath().Compare(Right);
+    }
+};
+
 class FileSys {
 public:
-    static List<String> TokenizePath(const StringView&);
     static String CanonicalizePath(const StringView&, const StringView& = "");
+    static StringView CanonicalizePath(const StringView&, const StringView&, Char*, UIntPtr);
 
     static Status Register(const FsImpl&);
     static Status CheckMountPoint(const StringView&);
@@ -103,12 +119,15 @@ public:
     static Status Unmount(const StringView&);
 private:
     static const FsImpl &GetFileSys(const StringView&);
-    static const MountPoint &GetMountPoint(const StringView&, String&);
+    static const MountPoint &GetMountPoint(const StringView&, StringView&);
+    static Boolean HasMountPoint(const HashSet<MountPoint>*, const StringView&);
 
     static const FsImpl EmptyFs;
     static const MountPoint EmptyMp;
     static List<FsImpl> FileSystems;
-    static List<MountPoint> MountPoints;
+    static HashMap<StringView, UIntPtr> FileSysNames;
+    static HashSet<MountPoint> *MountPoints;
+    static SpinLock MountLock;
 };
 
 }
@@ -0,0 +1,22 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 12:10 BRT
+ * Last edited on October 19 of 2026, at 12:10 BRT */
+
+#pragma once
+
+#include <sys/arch.hxx>
+
+namespace CHicago {
+
+/* Cores that have nothing to do shouldn't spin, they should sleep (hlt/mwait on x86) until the next interrupt. There is
+ * no need to program anything special for that, as the timer wheel of each core always keeps the hardware armed for
+ * the next deadline (so the core wakes up exactly when it has something to do, and not on a periodic tick). */
+
+class Idle {
+public:
+    static Void WaitFor(const volatile Boolean&);
+    static no_return Void Loop(Void);
+};
+
+}
@@ -0,0 +1,79 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 15:10 BRT
+ * Last edited on October 19 of 2026, at 15:10 BRT */
+
+#pragma once
+
+#include <sys/timer.hxx>
+
+/* How often (in milliseconds) a core with pending callbacks checks if the grace period that they're waiting for
+ * already ended. */
+
+#define RCU_POLL_INTERVAL 1
+
+namespace CHicago {
+
+/* Read-copy-update (quiescent-state based): readers of RCU-protected data only disable interrupts (no locks, no
+ * atomics, nothing that touches shared memory), and writers never modify anything that a reader might be looking at,
+ * they publish a new copy instead, and defer freeing the old one until every core went through a quiescent state.
+ * As readers run with interrupts disabled, taking any interrupt (or sleeping in the idle loop) means that the core is
+ * not inside a read-side section, so that's what we use as the quiescent states. Read-side sections should be short,
+ * and they should never block/yield. */
+
+struct RcuCallback {
+    RcuCallback *Next;
+    UInt64 Target;
+    Boolean Allocated;
+    Void (*Function)(Void*);
+    Void *Context;
+};
+
+/* Per-core state: the last grace period this core went through a quiescent state in, if it's idle right now (idle
+ * cores don't need to be waited for, as they can't be inside a read-side section), and the callbacks that were queued
+ * on this core (in the order they were queued, so also in the order of the grace period that they're waiting for). */
+
+struct RcuData {
+    volatile UInt64 Seen = 0;
+    volatile Boolean Idle = True;
+    SpinLock Lock {};
+    RcuCallback *Head = Null, *Tail = Null;
+    TimerEvent Poll {};
+};
+
+class Rcu {
+public:
+    static Void Initialize(Void);
+
+    static inline UIntPtr ReadLock(Void) {
+        UIntPtr Context;
+        ARCH_SENSITIVE_START();
+        return Context;
+    }
+
+    static inline Void ReadUnlock(UIntPtr Context) {
+        ARCH_SENSITIVE_END();
+    }
+
+    static Void Call(Void(*)(Void*), Void*);
+    static Void Call(RcuCallback&, Void(*)(Void*), Void* = Null);
+    static Void Synchronize(Void);
+
+    template<class T> static inline Void Delete(T *Ptr) {
+        if (Ptr != Null) Call([](Void *Data) { delete static_cast<T*>(Data); }, Ptr);
+    }
+
+    static Void Quiescent(Void);
+    static Void EnterIdle(Void);
+private:
+    static RcuData &GetData(Void);
+    static RcuData *GetData(UIntPtr);
+
+    static UInt64 Request(Void);
+    static Void Advance(Void);
+    static Void PollHandler(Void*);
+
+    static volatile UInt64 Started, Completed, Requested;
+};
+
+}
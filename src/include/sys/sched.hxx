@@ -0,0 +1,85 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 12:40 BRT
+ * Last edited on October 20 of 2026, at 00:20 BRT */
+
+#pragma once
+
+#include <sys/timer.hxx>
+
+/* How long each thread runs before being preempted (in milliseconds), and the size of the kernel stack of each thread
+ * (the boot context of each core keeps whatever stack it already had). */
+
+#define SCHED_QUANTUM 10
+#define SCHED_STACK_SIZE 0x4000
+
+namespace CHicago {
+
+enum class ThreadState { Ready, Running, Blocked, Dead };
+
+/* The saved context of each thread is whatever the arch-specific interrupt entry code pushed into the stack (on x86,
+ * that's the Registers struct), we just keep a pointer to it. The FPU/SIMD state is kept separately (and managed
+ * lazily by the arch-specific code). OnCpu stays set from the moment a core picks the thread until that core has
+ * actually left its stack (FinishSwitch), and other cores can't steal the thread while it's set. */
+
+struct Thread {
+    Thread *Next;
+    UIntPtr Id, Core;
+    UInt8 *Stack;
+    Void *Frame, *FpuState;
+    volatile ThreadState State;
+    Void (*Entry)(Void*);
+    Void *Argument;
+    volatile Boolean OnCpu;
+};
+
+/* Each core has its own run queue (so that picking the next thread never touches any shared state), with the thread
+ * that is currently running, the idle thread (which only runs when there is nothing else to do, and is never on the
+ * queue itself), the thread that we're switching away from (until we're off its stack), and the threads that exited
+ * but whose stack we couldn't free yet (as we were still running on it). */
+
+struct RunQueue {
+    SpinLock Lock {};
+    Thread *Head = Null, *Tail = Null, *Current = Null, *Idle = Null, *Previous = Null, *Dead = Null;
+    UIntPtr Id = 0, Length = 0;
+    volatile Boolean Resched = False;
+    TimerEvent Quantum {};
+};
+
+class Scheduler {
+public:
+    static Void Initialize(Void);
+
+    static Thread *CreateThread(Void(*)(Void*), Void* = Null);
+    static Void Yield(Void);
+    static Void Block(const volatile Boolean* = Null);
+    static Void Unblock(Thread&);
+    static Void WaitFor(const volatile Boolean&);
+    static no_return Void Exit(Void);
+
+    static Void *Schedule(Void*);
+    static Void FinishSwitch(Void);
+
+    [[nodiscard]] static Thread *GetCurrentThread(Void);
+private:
+    static Void InitializeArch(Thread&);
+    static RunQueue &GetQueue(Void);
+    static RunQueue *GetQueue(UIntPtr);
+    static Void *CreateFrame(Thread&);
+    static Void *CreateFpuState(Void);
+    static Void FreeFpuState(Void*);
+    static Void Switch(Thread&, Thread&);
+    static Void Trigger(Void);
+    static Void Wake(UIntPtr);
+
+    static no_return Void Start(Void);
+    static Void Enqueue(RunQueue&, Thread&);
+    static Thread *Dequeue(RunQueue&, const Thread* = Null);
+    static Thread *Steal(RunQueue&);
+    static Void WakeIdle(RunQueue&);
+    static Void QuantumHandler(Void*);
+
+    static UIntPtr NextId;
+};
+
+}
@@ -0,0 +1,104 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 10:05 BRT
+ * Last edited on October 20 of 2026, at 10:30 BRT */
+
+#pragma once
+
+#include <sys/arch.hxx>
+#include <sys/call.hxx>
+#include <sys/work.hxx>
+#include <util/lock.hxx>
+
+/* The timing wheel works on units of 2^TIMER_WHEEL_SHIFT nanoseconds (so, a bit more than a microsecond), and each
+ * level has 64 slots (each slot of level N covering 64^N units), so 8 levels are enough for deadlines up to about 9
+ * years into the future (anything further than that gets clamped). */
+
+#define TIMER_WHEEL_SHIFT 10
+#define TIMER_WHEEL_LEVEL_SHIFT 6
+#define TIMER_WHEEL_LEVEL_SIZE (1 << TIMER_WHEEL_LEVEL_SHIFT)
+#define TIMER_WHEEL_LEVELS 8
+#define TIMER_WHEEL_MAX_DELTA ((1ull << (TIMER_WHEEL_LEVEL_SHIFT * TIMER_WHEEL_LEVELS)) - 1)
+#define TIMER_WHEEL_NONE 0xFFFFFFFFFFFFFFFF
+
+namespace CHicago {
+
+class TimerWheel;
+
+/* Timer events are owned by whoever wants to be called back (the wheel only links them), so that adding/removing them
+ * never has to allocate anything, and the event itself works as the handle for cancelling it. Handlers are not called
+ * from the timer interrupt itself, but from deferred work (so they should not block either). */
+
+struct TimerEvent {
+    TimerEvent *Next, *Prev;
+    TimerWheel *Wheel;
+    UInt64 Deadline;
+    UInt8 Level, Slot;
+    Boolean Allocated;
+    Void (*Handler)(Void*);
+    Void *Context;
+};
+
+/* The clock source is whatever free running counter we use for the system uptime (TSC, HPET, etc). Converting counter
+ * ticks into nanoseconds is done using a (precomputed) 32-bit multiplier and shift, and both the raw counter and the
+ * uptime at the point the source was set are saved, so that switching between sources doesn't make time go back. It
+ * is protected by a SeqLock, as it's read on every GetUpTime call (on every core), but only written a few times during
+ * boot. */
+
+struct ClockSource {
+    const Char *Name;
+    UInt64 (*Read)(Void);
+    UInt64 Base, Offset;
+    UInt32 Mult, Shift;
+};
+
+class TimerWheel {
+public:
+    /* The owner is the core that handles the interrupts of whatever hardware timer drives the wheel (and so, where
+     * CancelEvent sends the re-arm request to); it never changes after the wheel is created. */
+
+    TimerWheel(UIntPtr Core = 0) : Core(Core) { }
+
+    Boolean Add(TimerEvent&);
+    Boolean Remove(TimerEvent&);
+    Boolean Advance(UInt64);
+
+    [[nodiscard]] UInt64 GetNextDeadline(Void) const;
+    [[nodiscard]] UInt64 GetCurrent(Void) const { return Current; }
+private:
+    friend class Timer;
+
+    Void Insert(TimerEvent&);
+    static Void RunExpired(Void*);
+
+    SpinLock Lock;
+    UIntPtr Core;
+    UInt64 Armed = TIMER_WHEEL_NONE, Current = 0, Occupied[TIMER_WHEEL_LEVELS] {};
+    TimerEvent *Slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_LEVEL_SIZE] {}, *Expired = Null;
+    DeferredWork Work { Null, False, RunExpired, this };
+    CrossCall Reprogram {};
+};
+
+class Timer {
+public:
+    static Boolean SetEvent(TimeUnit, UInt64, Void(*)(Void*));
+    static Boolean SetEvent(TimerEvent&, TimeUnit, UInt64, Void(*)(Void*), Void* = Null);
+    static Boolean CancelEvent(TimerEvent&);
+    static Void Process(Void);
+
+    static Void SetClockSource(const Char*, UInt64(*)(Void), UInt64, UInt64);
+    static Void Sleep(TimeUnit, UInt64);
+    static UInt64 GetUpTime(TimeUnit);
+
+    [[nodiscard]] static ClockSource GetClockSource(Void);
+private:
+    static TimerWheel &GetWheel(Void);
+    static Void Arm(UInt64);
+    static Void Reprogram(Void*);
+    static UInt64 GetUpTime(const ClockSource&, TimeUnit);
+
+    static ClockSource Source;
+    static SeqLock SourceLock;
+};
+
+}
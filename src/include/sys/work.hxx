@@ -0,0 +1,48 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 16:55 BRT
+ * Last edited on October 19 of 2026, at 16:55 BRT */
+
+#pragma once
+
+#include <sys/arch.hxx>
+#include <util/lock.hxx>
+
+/* How many work items we run per pass (at the end of each interrupt), anything left after that waits for the next
+ * pass (which we trigger right away, so that other interrupts get a chance to come in between). */
+
+#define WORK_BUDGET 32
+
+namespace CHicago {
+
+/* Interrupt handlers should do the bare minimum (acknowledge the device, grab whatever data is needed), and defer
+ * everything else: work items are owned by whoever queues them (just like the timer events), queueing them is
+ * lock-free (and queueing something that is already queued does nothing), and they run on the same core, after the
+ * EOI, with interrupts enabled (but still in interrupt context, so they can't block). */
+
+struct DeferredWork {
+    DeferredWork *Next;
+    volatile Boolean Queued;
+    Void (*Function)(Void*);
+    Void *Context;
+};
+
+/* Each core has its own queue: anyone can push into the incoming list (it's a lock-free stack), but only the core
+ * itself takes things out of it (moving them into the pending list, in the order they were queued). */
+
+struct WorkQueue {
+    DeferredWork *volatile Incoming = Null;
+    DeferredWork *Head = Null, *Tail = Null;
+    Boolean Running = False;
+};
+
+class Work {
+public:
+    static Boolean Queue(DeferredWork&);
+    static Void Run(Void);
+private:
+    static WorkQueue &GetQueue(Void);
+    static Void Trigger(Void);
+};
+
+}
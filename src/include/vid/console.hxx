@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 05 of 2021, at 13:26 BRT
- * Last edited on July 20 of 2021, at 13:46 BRT */
+ * Last edited on October 20 of 2026, at 00:50 BRT */
 
 #pragma once
 
@@ -20,11 +20,14 @@ public:
     Void DisableGraphics(Void);
 private:
     Boolean WriteInt(Char) override;
+    Boolean WriteStringInt(const Char*, UIntPtr) override;
     Void SetBackgroundInt(UInt32) override;
     Void SetForegroundInt(UInt32) override;
     Void RestoreBackgroundInt(Void) override;
     Void RestoreForegroundInt(Void) override;
 
+    Boolean DrawCharacter(Char);
+
     Image Back {}, Front {};
     Boolean Initialized = False;
     UInt16 X = 0, BackY = 0, FrontY = 0;
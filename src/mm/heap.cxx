@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 14 of 2021, at 23:45 BRT
- * Last edited on July 19 of 2021, at 20:46 BRT */
+ * Last edited on October 19 of 2026, at 23:20 BRT */
 
 #include <sys/mm.hxx>
 #include <sys/panic.hxx>
@@ -11,6 +11,111 @@ using namespace CHicago;
 SpinLock Heap::Lock {};
 Heap::Block *Heap::Head = Null, *Heap::Tail = Null;
 
+#ifdef HEAP_DEBUG
+Heap::Block *Heap::Quarantine[HEAP_DEBUG_QUARANTINE_SIZE] {};
+Heap::Site Heap::Sites[HEAP_DEBUG_SITE_COUNT] {};
+UIntPtr Heap::QuarantineIndex = 0, Heap::SampleCounter = 0;
+
+static Boolean CheckPattern(const UInt8 *Data, UInt8 Pattern, UIntPtr Length) {
+    /* Red zones are small (and the quarantine is only for the sampled blocks), so we don't need anything fancy here,
+     * just check 8 bytes at a time while possible, and the rest byte by byte. */
+
+    UInt64 pat = Pattern * 0x0101010101010101;
+
+    for (; Length >= 8; Data += 8, Length -= 8) {
+        UInt64 val;
+        CopyMemory(&val, Data, 8);
+        if (val != pat) return False;
+    }
+
+    for (; Length; Length--) if (*Data++ != Pattern) return False;
+
+    return True;
+}
+
+no_return Void Heap::Corrupted(const Char *Message, Block *Block) {
+    /* Same as the other panic functions, but we also want to say who allocated the block (as that is almost always
+     * more useful than the backtrace itself, which will only point to whoever called Free). */
+
+    UIntPtr off;
+    StringView name;
+
+    Arch::EnterPanicState();
+    Debug.Write("{}panic in core {}: heap: {} at 0x{:0*:16} ({} bytes)\n", SetForeground { 0xFFFF0000 },
+                Arch::GetCoreId(), Message, Block->Data, Block->Requested);
+
+    if (StackTrace::GetSymbol(Block->Site, name, off))
+        Debug.Write("allocated at 0x{:0*:16}: {} +0x{:0:16}\n", Block->Site, name, off);
+    else Debug.Write("allocated at 0x{:0*:16}: <no symbol information available>\n", Block->Site);
+
+    StackTrace::Dump();
+    Arch::Halt(True);
+}
+
+Void Heap::Track(Block *Block, UIntPtr Requested, UIntPtr Site) {
+    /* Everything after the size the caller asked for is red zone (there is always at least HEAP_DEBUG_RED_ZONE bytes
+     * of it), which Free will check before doing anything else. Only one out of HEAP_DEBUG_SAMPLE_RATE blocks goes
+     * into the site table (and later into the quarantine), as doing that for every allocation is way too slow. */
+
+    Block->Site = Site;
+    Block->Requested = Requested;
+    Block->Flags = 0;
+
+    SetMemory(&Block->Data[Requested], HEAP_DEBUG_RED_ZONE_BYTE, Block->Size - Requested);
+
+    if (++SampleCounter % HEAP_DEBUG_SAMPLE_RATE) return;
+
+    for (UIntPtr i = 0, idx = (Site >> 2) % HEAP_DEBUG_SITE_COUNT; i < HEAP_DEBUG_SITE_COUNT;
+         i++, idx = (idx + 1) % HEAP_DEBUG_SITE_COUNT) {
+        Heap::Site &ent = Sites[idx];
+        if (ent.Address && ent.Address != Site) continue;
+        ent.Address = Site;
+        ent.Count++;
+        ent.Bytes += Requested;
+        Block->Flags |= HEAP_DEBUG_SAMPLED;
+        break;
+    }
+}
+
+Void Heap::Untrack(Block *Block) {
+    for (UIntPtr i = 0, idx = (Block->Site >> 2) % HEAP_DEBUG_SITE_COUNT; i < HEAP_DEBUG_SITE_COUNT;
+         i++, idx = (idx + 1) % HEAP_DEBUG_SITE_COUNT) {
+        Heap::Site &ent = Sites[idx];
+        if (ent.Address != Block->Site) continue;
+        ent.Count--;
+        ent.Bytes -= Block->Requested;
+        break;
+    }
+}
+
+Void Heap::DumpLeaks(Void) {
+    /* Everything that is still in the site table is (from the sampled allocations) still alive, so just print
+     * everything, grouped by who allocated it. */
+
+    UIntPtr count = 0, bytes = 0, off;
+
+    Lock.Acquire();
+    Debug.Write("live heap allocations (sampling 1 out of every {} allocations):\n", HEAP_DEBUG_SAMPLE_RATE);
+
+    for (const Heap::Site &ent : Sites) {
+        StringView name;
+
+        if (!ent.Count) continue;
+        else if (StackTrace::GetSymbol(ent.Address, name, off))
+            Debug.Write("    0x{:0*:16}: {} +0x{:0:16}: {} blocks, {} bytes\n", ent.Address, name, off, ent.Count,
+                        ent.Bytes);
+        else Debug.Write("    0x{:0*:16}: <no symbol information available>: {} blocks, {} bytes\n", ent.Address,
+                         ent.Count, ent.Bytes);
+
+        count += ent.Count;
+        bytes += ent.Bytes;
+    }
+
+    Debug.Write("{} sampled blocks ({} bytes) still alive\n", count, bytes);
+    Lock.Release();
+}
+#endif
+
 Void Heap::ReturnMemory(Void) {
     /* Just find any blocks that are free and have the size as a multiple of the page size (and the block header address
      * itself is aligned to the page size). */
@@ -42,9 +147,12 @@ Void Heap::ReturnMemory(Void) {
     Lock.Release();
 }
 
-Void *Heap::Allocate(UIntPtr Size) {
+Heap::Block *Heap::AllocateBlock(UIntPtr Size) {
+    /* Size should already be 16-byte aligned here; On success, we return with the lock held (so that the caller can
+     * finish setting up the block). */
+
     Lock.Acquire();
-    Block *block = FindFree(Size += -Size & 0x0F);
+    Block *block = FindFree(Size);
 
     if (block != Null) RemoveFree(block);
     else {
@@ -56,7 +164,23 @@ Void *Heap::Allocate(UIntPtr Size) {
         Lock.Acquire();
     }
 
-    return Split(block, Size), Lock.Release(), SetMemory(block->Data, 0, block->Size), block->Data;
+    return Split(block, Size), block;
+}
+
+Void *Heap::Allocate(UIntPtr Size) {
+#ifdef HEAP_DEBUG
+    UIntPtr requested = Size, site = reinterpret_cast<UIntPtr>(__builtin_return_address(0));
+    Size += HEAP_DEBUG_RED_ZONE;
+#endif
+
+    Block *block = AllocateBlock(Size += -Size & 0x0F);
+    if (block == Null) return Null;
+
+#ifdef HEAP_DEBUG
+    return Track(block, requested, site), Lock.Release(), SetMemory(block->Data, 0, requested), block->Data;
+#else
+    return Lock.Release(), SetMemory(block->Data, 0, block->Size), block->Data;
+#endif
 }
 
 Void *Heap::Allocate(UIntPtr Size, UIntPtr Align) {
@@ -65,6 +189,11 @@ Void *Heap::Allocate(UIntPtr Size, UIntPtr Align) {
     if (!Align || Align & (Align - 1)) return Null;
     if (Align <= 16) return Allocate(Size);
 
+#ifdef HEAP_DEBUG
+    UIntPtr requested = Size, site = reinterpret_cast<UIntPtr>(__builtin_return_address(0));
+    Size += HEAP_DEBUG_RED_ZONE;
+#endif
+
     Size += -Size & 0x0F;
 
     /* There are two different blocks that we can use: With the ->Data field perfectly aligned, and with enough size
@@ -94,7 +223,91 @@ Void *Heap::Allocate(UIntPtr Size, UIntPtr Align) {
         cur = Split(cur, size, False);
     }
 
+#ifdef HEAP_DEBUG
+    return Split(cur, Size), Track(cur, requested, site), Lock.Release(), SetMemory(cur->Data, 0, requested),
+           cur->Data;
+#else
     return Split(cur, Size), Lock.Release(), SetMemory(cur->Data, 0, cur->Size), cur->Data;
+#endif
+}
+
+Void *Heap::Reallocate(Void *Data, UIntPtr Size) {
+    /* Data needs to be something that we allocated (use Allocate for the first allocation), and, like Allocate, any
+     * new space is zeroed. Shrinking always happens in place (the end of the block goes back into the free list), and
+     * growing also does if the block right after this one is free and big enough; Only if that fails we need to
+     * allocate a new block and copy everything. */
+
+    if (Data == Null || !Size) return Null;
+
+    auto blk = reinterpret_cast<Block*>(reinterpret_cast<UIntPtr>(Data) - sizeof(Block) + sizeof(Block::Free));
+    Block *nblk;
+    UIntPtr old;
+
+#ifdef HEAP_DEBUG
+    /* On debug builds, we always move the block: This way, the red zone/tracking info is set up the same way as
+     * Allocate, and anyone still using the old pointer hits the poisoned (and maybe quarantined) block. */
+
+    UIntPtr requested = Size, site = reinterpret_cast<UIntPtr>(__builtin_return_address(0));
+
+    ASSERT(blk->Magic == ALLOC_BLOCK_MAGIC);
+    Size += HEAP_DEBUG_RED_ZONE;
+    old = blk->Requested;
+
+    if ((nblk = AllocateBlock(Size += -Size & 0x0F)) == Null) return Null;
+
+    Track(nblk, requested, site);
+    Lock.Release();
+
+    CopyMemory(nblk->Data, Data, old < requested ? old : requested);
+    if (requested > old) SetMemory(&nblk->Data[old], 0, requested - old);
+#else
+    UIntPtr requested = Size;
+
+    Lock.Acquire();
+    ASSERT(blk->Magic == ALLOC_BLOCK_MAGIC);
+
+    old = blk->Size;
+    Size += -Size & 0x0F;
+
+    if (Size > old) {
+        /* The free list is sorted by address, so finding out if the next block is free is just a matter of walking it
+         * until we reach (or pass) the end of this block. */
+
+        UIntPtr end = reinterpret_cast<UIntPtr>(blk->Data) + old;
+        for (nblk = Head; nblk != Null && reinterpret_cast<UIntPtr>(nblk) < end; nblk = nblk->Next) ;
+
+        if (nblk != Null && reinterpret_cast<UIntPtr>(nblk) == end &&
+            old + nblk->Size + sizeof(Block) - sizeof(Block::Free) >= Size) {
+            RemoveFree(nblk);
+            blk->Size += nblk->Size + sizeof(Block) - sizeof(Block::Free);
+        }
+    }
+
+    if (Size <= blk->Size) {
+        /* Fits in place, give back whatever is left (Release also fuses it with the next block, if it is free), and
+         * zero the new space. When shrinking, we also zero everything after the new size that is still part of the
+         * block (the alignment, and whatever was too small to split), so that growing into it later doesn't expose
+         * old data. */
+
+        if ((nblk = Split(blk, Size, False)) != Null) Release(nblk);
+        Lock.Release();
+
+        if (requested < old) old = requested;
+        SetMemory(&blk->Data[old], 0, blk->Size - old);
+
+        return Data;
+    }
+
+    Lock.Release();
+
+    if ((nblk = AllocateBlock(Size)) == Null) return Null;
+
+    Lock.Release();
+    CopyMemory(nblk->Data, Data, old);
+    SetMemory(&nblk->Data[old], 0, nblk->Size - old);
+#endif
+
+    return Free(Data), nblk->Data;
 }
 
 Void Heap::Free(Void *Data) {
@@ -103,11 +316,45 @@ Void Heap::Free(Void *Data) {
     auto addr = reinterpret_cast<UIntPtr>(Data);
     auto blk = reinterpret_cast<Block*>(addr - sizeof(Block) + sizeof(Block::Free));
 
+    ASSERT(addr);
+#ifdef HEAP_DEBUG
+    if (blk->Magic == ALLOC_BLOCK_QUARANTINE_MAGIC) Corrupted("double free", blk);
+#endif
+    ASSERT(blk->Magic == ALLOC_BLOCK_MAGIC);
+
+#ifdef HEAP_DEBUG
+    /* Check if nobody wrote past the end of the block, and poison it (so that anyone still using it will at least
+     * read garbage). Sampled blocks also go into the quarantine instead of being freed right away, and whatever block
+     * we end up kicking out of there gets checked for writes after the free. */
+
+    if (!CheckPattern(&blk->Data[blk->Requested], HEAP_DEBUG_RED_ZONE_BYTE, blk->Size - blk->Requested))
+        Corrupted("red zone overwritten", blk);
+
+    SetMemory(blk->Data, HEAP_DEBUG_POISON_BYTE, blk->Size);
+
+    if (blk->Flags & HEAP_DEBUG_SAMPLED) {
+        Untrack(blk);
+        blk->Magic = ALLOC_BLOCK_QUARANTINE_MAGIC;
+        blk = Exchange(Quarantine[QuarantineIndex], blk);
+        QuarantineIndex = (QuarantineIndex + 1) % HEAP_DEBUG_QUARANTINE_SIZE;
+
+        if (blk == Null) return Lock.Release();
+        else if (!CheckPattern(blk->Data, HEAP_DEBUG_POISON_BYTE, blk->Size)) Corrupted("use after free", blk);
+
+        blk->Magic = ALLOC_BLOCK_MAGIC;
+    }
+#endif
+
+    Release(blk);
+    Lock.Release();
+}
+
+Void Heap::Release(Block *Freed) {
     /* AddFree should also return if it finds that the block is already in the list, so there is no need to manually
      * check that. */
 
-    ASSERT(addr);
-    ASSERT(blk->Magic == ALLOC_BLOCK_MAGIC);
+    Block *blk = Freed;
+
     ASSERT(AddFree(blk));
 
     /* Fuse the block in both directions (all in the same loop). */
@@ -136,8 +383,6 @@ Void Heap::Free(Void *Data) {
 
         if (!fuse) break;
     }
-
-    Lock.Release();
 }
 
 Heap::Block *Heap::Split(Block *Block, UIntPtr Size, Boolean Free) {
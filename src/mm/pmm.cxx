@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on July 01 of 2020, at 19:47 BRT
- * Last edited on July 19 of 2021, at 20:04 BRT */
+ * Last edited on October 19 of 2026, at 22:45 BRT */
 
 #include <sys/mm.hxx>
 #include <sys/panic.hxx>
@@ -117,7 +117,7 @@ Status PhysMem::Allocate(UIntPtr Count, UInt64 *Out, UInt64 Align) {
      * consecutive pages. */
 
     if (!Count || Out == Null || !Align || Align & (Align - 1)) {
-        Debug.Write("invalid non-contig PhysMem::Allocate arguments (count = {}, out = 0x{:016:16}, align = {}){}\n",
+        Debug.Write("{}invalid non-contig PhysMem::Allocate arguments (count = {}, out = 0x{:016:16}, align = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Count, Out, Align, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -140,7 +140,7 @@ Status PhysMem::Allocate(UIntPtr Count, UInt64 *Out, UInt64 Align) {
 Status PhysMem::Free(UInt64 Start, UIntPtr Count) {
     if (Pages == Null || UsedBytes < (Count << PAGE_SHIFT) || (Start & PAGE_MASK) || Start < MinAddress ||
         Start + (Count << PAGE_SHIFT) >= MaxAddress) {
-        Debug.Write("invalid PhysMem::Free arguments (start = 0x{:016:16}, count = {}){}\n",
+        Debug.Write("{}invalid PhysMem::Free arguments (start = 0x{:016:16}, count = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Start, Count, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -153,7 +153,7 @@ Status PhysMem::Free(UInt64 Start, UIntPtr Count) {
 
 Status PhysMem::Free(UInt64 *Pages, UIntPtr Count) {
     if (!Count || UsedBytes < (Count << PAGE_SHIFT) || Pages == Null) {
-        Debug.Write("invalid non-contig PhysMem::Free arguments (pages = 0x{:0*:16}, count = {}){}\n",
+        Debug.Write("{}invalid non-contig PhysMem::Free arguments (pages = 0x{:0*:16}, count = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Pages, Count, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -176,7 +176,7 @@ Status PhysMem::Reference(UInt64 Start, UIntPtr Count, UInt64 &Out, UInt64 Align
         return Reference(Start, Count, Out, Align);
     } else if (Pages == Null || !Count || UsedBytes < (Count << PAGE_SHIFT) || (Start & PAGE_MASK) ||
                Start < MinAddress || Start + (Count << PAGE_SHIFT) > MaxAddress || !Align || Align & (Align - 1)) {
-        Debug.Write("invalid PhysMem::Reference arguments (start = 0x{:016:16}, count = {}, align = {}){}\n",
+        Debug.Write("{}invalid PhysMem::Reference arguments (start = 0x{:016:16}, count = {}, align = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Start, Count, Align, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -190,7 +190,8 @@ Status PhysMem::Reference(UInt64 *Pages, UIntPtr Count, UInt64 *Out, UInt64 Alig
     /* For non-contig pages, we just call ReferenceSingle on each of the pages. */
 
     if (Pages == Null || !Count || UsedBytes < (Count << PAGE_SHIFT) || Out == Null || !Align || Align & (Align - 1)) {
-        Debug.Write("invalid non-contig PhysMem::Reference arguments (pages = 0x{:0*:16}, count = {}, align = {}){}\n",
+        Debug.Write("{}invalid non-contig PhysMem::Reference arguments "
+                    "(pages = 0x{:0*:16}, count = {}, align = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Pages, Count, Align, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -214,7 +215,7 @@ Status PhysMem::Reference(UInt64 *Pages, UIntPtr Count, UInt64 *Out, UInt64 Alig
 Status PhysMem::Dereference(UInt64 Start, UIntPtr Count) {
     if (Pages == Null || !Count || UsedBytes < (Count << PAGE_SHIFT) || !Start || (Start & PAGE_MASK) ||
         Start < MinAddress || Start + (Count << PAGE_SHIFT) > MaxAddress) {
-        Debug.Write("Invalid PhysMem::Dereference arguments (start = 0x{:016:16}, count = {}){}\n",
+        Debug.Write("{}Invalid PhysMem::Dereference arguments (start = 0x{:016:16}, count = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Start, Count, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -228,7 +229,7 @@ Status PhysMem::Dereference(UInt64 Start, UIntPtr Count) {
 
 Status PhysMem::Dereference(UInt64 *Pages, UIntPtr Count) {
     if (Pages == Null || !Count || UsedBytes < (Count << PAGE_SHIFT)) {
-        Debug.Write("invalid non-contig PhysMem::DereferenceNonContig arguments (pages = 0x{:0*:16}, count = {}){}\n",
+        Debug.Write("{}invalid non-contig PhysMem::DereferenceNonContig arguments (pages = 0x{:0*:16}, count = {}){}\n",
                     SetForeground { 0xFFFF0000 }, Pages, Count, RestoreForeground{});
         return Status::InvalidArg;
     }
@@ -240,7 +241,7 @@ Status PhysMem::Dereference(UInt64 *Pages, UIntPtr Count) {
 
 UIntPtr PhysMem::GetReferences(UInt64 Page) {
     if (Pages == Null || Page < PAGE_SIZE || (Page & PAGE_MASK) || Page < MinAddress || Page >= MaxAddress) {
-        Debug.Write("Invalid PhysMem::GetReferences arguments (page = 0x{:016:16}){}\n", SetForeground { 0xFFFF0000 },
+        Debug.Write("{}Invalid PhysMem::GetReferences arguments (page = 0x{:016:16}){}\n", SetForeground { 0xFFFF0000 },
                     Page, RestoreForeground{});
         return 0;
     }
@@ -1,19 +1,22 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on March 11 of 2021, at 18:08 BRT
- * Last edited on July 20 of 2021, at 09:37 BRT */
+ * Last edited on October 19 of 2026, at 23:55 BRT */
 
+#include <ds/hashmap.hxx>
 #include <sys/mm.hxx>
 #include <sys/panic.hxx>
 
 namespace CHicago {
 
-List<Acpi::CacheEntry> Acpi::Cache {};
+HashMap<UInt32, Acpi::CacheEntry> Acpi::Cache {};
 
 Void Acpi::Initialize(const BootInfo &Info) {
     /* This function should really only be called one time, but we can have an idea if it was called before using the
      * cache (if it isn't 0, we have been called before, that's for sure). Here we map the main SDT table, grab all
-     * the subtables, and cache them so that we can search without having to map every single entry every tine. */
+     * the subtables, and cache them so that we can search without having to map every single entry every tine. Some
+     * tables can appear more than once (like the SSDTs), but GetHeader only ever returned the first one, so that is
+     * the one we keep. */
 
     UIntPtr size = Info.Acpi.Size + (-Info.Acpi.Size & PAGE_MASK), addr;
 
@@ -28,9 +31,10 @@ Void Acpi::Initialize(const BootInfo &Info) {
         if (VirtMem::MapIo(phys, size2, addr2) != Status::Success) continue;
 
         auto hdr = reinterpret_cast<const SdtHeader*>(addr2);
+        UInt32 sig;
 
-        if (Cache.Add({ hdr->Length + (-hdr->Length & PAGE_MASK), phys, {} }) == Status::Success)
-            CopyMemory(Cache[Cache.GetLength() - 1].Signature, hdr->Signature, 4);
+        CopyMemory(&sig, hdr->Signature, 4);
+        Cache.Add(sig, { hdr->Length + (-hdr->Length & PAGE_MASK), phys });
 
         VirtMem::Unmap(addr2 & ~PAGE_MASK, size2);
         VirtMem::Free(addr2 & ~PAGE_MASK, size2 >> PAGE_SHIFT);
@@ -47,14 +51,15 @@ Acpi::SdtHeader *Acpi::GetHeader(const Char Sig[4], UIntPtr &Out) {
      * so there is no need to "guess" it. */
 
     UIntPtr addr;
+    UInt32 sig;
+    const CacheEntry *ent;
 
-    for (auto &ent : Cache) {
-        if (!CompareMemory(ent.Signature, Sig, 4)) continue;
-        return VirtMem::MapIo(ent.Address, (Out = ent.Size, Out), addr) == Status::Success ?
-               reinterpret_cast<SdtHeader*>(addr) : Null;
-    }
+    CopyMemory(&sig, Sig, 4);
+
+    if ((ent = Cache.Find(sig)) == Null) return Null;
 
-    return Null;
+    return VirtMem::MapIo(ent->Address, (Out = ent->Size, Out), addr) == Status::Success ?
+           reinterpret_cast<SdtHeader*>(addr) : Null;
 }
 
 }
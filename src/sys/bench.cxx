@@ -0,0 +1,185 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 10:00 BRT
+ * Last edited on October 20 of 2026, at 10:00 BRT */
+
+#ifdef BENCHMARK
+
+#include <sys/bench.hxx>
+#include <sys/call.hxx>
+#include <sys/sched.hxx>
+#include <vid/console.hxx>
+
+using namespace CHicago;
+
+/* The old lock (test-and-test-and-set on a single flag), so that we have something to compare the ticket lock with. It
+ * doesn't need to save the interrupt state, as the benchmark always runs with interrupts disabled. */
+
+class TasLock {
+public:
+    inline Void Acquire(Void) {
+        while (AtomicExchange(Value, True, __ATOMIC_ACQUIRE)) while (AtomicLoad(Value, __ATOMIC_RELAXED)) ARCH_PAUSE();
+    }
+
+    inline Void Release(Void) { AtomicStore(Value, False, __ATOMIC_RELEASE); }
+private:
+    volatile Boolean Value = False;
+};
+
+/* Everything that the cores share during a lock round: the lock itself and the data that it protects live on their own
+ * cache lines (just like any real lock would), and each core writes its own results into its own slot. */
+
+struct aligned(64) BenchSlot {
+    UInt64 Time;
+};
+
+struct BenchLockRound {
+    aligned(64) SpinLock Ticket {};
+    aligned(64) TasLock Tas {};
+    aligned(64) volatile UInt64 Counter = 0;
+    aligned(64) volatile UIntPtr Arrived = 0, Next = 0;
+    UIntPtr Cores = 0;
+    Boolean UseTicket = True;
+    BenchSlot *Slots = Null;
+};
+
+struct BenchThreads {
+    volatile UIntPtr Left = 0;
+    volatile Boolean Done = False;
+    Thread *Waiter = Null;
+};
+
+static Void CountHandler(Void *Context) {
+    AtomicAddFetch(*static_cast<volatile UIntPtr*>(Context), 1);
+}
+
+static Void LockHandler(Void *Context) {
+    /* Only the first Cores cores (in the order they get here) take part in the round, and all of them start at the same
+     * time (after everyone got here), as otherwise the first one would be done before the last one even started. */
+
+    auto &round = *static_cast<BenchLockRound*>(Context);
+    UIntPtr id = AtomicFetchAdd(round.Next, 1);
+
+    if (id >= round.Cores) return;
+
+    AtomicAddFetch(round.Arrived, 1);
+    while (AtomicLoad(round.Arrived) != round.Cores) ARCH_PAUSE();
+
+    UInt64 start = Timer::GetUpTime(TimeUnit::Nanoseconds);
+
+    for (UIntPtr i = 0; i < BENCH_LOCK_ITERATIONS; i++) {
+        if (round.UseTicket) {
+            round.Ticket.Acquire();
+            round.Counter = round.Counter + 1;
+            round.Ticket.Release();
+        } else {
+            round.Tas.Acquire();
+            round.Counter = round.Counter + 1;
+            round.Tas.Release();
+        }
+    }
+
+    round.Slots[id].Time = Timer::GetUpTime(TimeUnit::Nanoseconds) - start;
+}
+
+static Void ThreadEntry(Void *Context) {
+    /* What most kernel threads do all the time: allocate something, fill/copy/scan it, free it, and give the core to
+     * someone else. None of this is FP/SIMD work, so with the FPU state managed lazily, this shouldn't fault at all. */
+
+    auto &ctx = *static_cast<BenchThreads*>(Context);
+
+    for (UIntPtr i = 0; i < BENCH_THREAD_ITERATIONS; i++) {
+        auto buf = new Char[256];
+
+        if (buf != Null) {
+            SetMemory(buf, 'a', 255);
+            buf[255] = 0;
+            CopyMemory(buf, buf + 128, StringLength(buf) - 128);
+            delete[] buf;
+        }
+
+        Scheduler::Yield();
+    }
+
+    if (AtomicSubFetch(ctx.Left, 1)) Scheduler::Exit();
+
+    AtomicStore(ctx.Done, True);
+    Scheduler::Unblock(*ctx.Waiter);
+    Scheduler::Exit();
+}
+
+Void Benchmark::Run(Void) {
+    Debug.Write("{}running the boot-time benchmarks{}\n", SetForeground { 0xFF00FF00 }, RestoreForeground{});
+    RunLocks();
+    RunThreads();
+}
+
+Void Benchmark::RunLocks(Void) {
+    /* Contention benchmark: N cores (1, 2, 4, ... up to every core that we have) hammering the same lock (with an
+     * almost empty critical section, so this is pretty much the worst case), for both the ticket lock and the old
+     * test-and-set lock. Besides the throughput, the difference between the fastest and the slowest core shows how fair
+     * the lock is (with a fair lock, everyone finishes at about the same time). */
+
+    volatile UIntPtr online = 0;
+
+    Call::RunOnAll(CountHandler, const_cast<UIntPtr*>(&online));
+
+    auto slots = new BenchSlot[online];
+    if (slots == Null) return;
+
+    for (UIntPtr cores = 1;; cores = cores * 2 > online && cores != online ? online : cores * 2) {
+        for (UIntPtr ticket = 0; ticket < 2; ticket++) {
+            BenchLockRound round;
+            UInt64 min = 0xFFFFFFFFFFFFFFFF, max = 0;
+
+            round.Cores = cores;
+            round.UseTicket = !ticket;
+            round.Slots = slots;
+
+            Call::RunOnAll(LockHandler, &round);
+
+            for (UIntPtr i = 0; i < cores; i++) {
+                if (slots[i].Time < min) min = slots[i].Time;
+                if (slots[i].Time > max) max = slots[i].Time;
+            }
+
+            Debug.Write("{} lock, {} core(s): {} ns per acquire, fastest core took {} us, slowest {} us{}\n",
+                        !ticket ? "ticket" : "test-and-set", cores,
+                        max / (static_cast<UInt64>(BENCH_LOCK_ITERATIONS) * cores), min / 1000, max / 1000,
+                        round.Counter == static_cast<UInt64>(BENCH_LOCK_ITERATIONS) * cores ? "" : " (LOST UPDATES)");
+        }
+
+        if (cores == online) break;
+    }
+
+    delete[] slots;
+}
+
+Void Benchmark::RunThreads(Void) {
+    /* Two threads per core, yielding to each other all the time, and doing the usual allocate/copy work in between.
+     * We report how many #NM faults (lazy FPU restores) that caused, per thread switch. */
+
+    volatile UIntPtr online = 0;
+    BenchThreads ctx;
+
+    Call::RunOnAll(CountHandler, const_cast<UIntPtr*>(&online));
+
+    UIntPtr count = online * 2, faults = Arch::GetFpuFaultCount();
+    UInt64 start = Timer::GetUpTime(TimeUnit::Nanoseconds);
+
+    ctx.Left = count;
+    ctx.Waiter = Scheduler::GetCurrentThread();
+
+    for (UIntPtr i = 0; i < count; i++) {
+        if (Scheduler::CreateThread(ThreadEntry, &ctx) == Null && !AtomicSubFetch(ctx.Left, 1))
+            AtomicStore(ctx.Done, True);
+    }
+
+    Scheduler::WaitFor(ctx.Done);
+
+    Debug.Write("{} threads did {} yields each in {} ms, with {} #NM faults in total\n", count,
+                BENCH_THREAD_ITERATIONS, (Timer::GetUpTime(TimeUnit::Nanoseconds) - start) / 1000000,
+                Arch::GetFpuFaultCount() - faults);
+}
+
+#endif
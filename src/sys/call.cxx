@@ -0,0 +1,173 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 17:30 BRT
+ * Last edited on October 19 of 2026, at 17:30 BRT */
+
+#include <sys/call.hxx>
+#include <sys/panic.hxx>
+
+using namespace CHicago;
+
+static Void HaltHandler(Void*) {
+    Arch::Halt(True);
+}
+
+Void Call::Initialize(Void) {
+    /* This should be called once on each core, with interrupts disabled, after the core list is final (we need to know
+     * how many requests to allocate for the synchronous calls). After this, other cores can start sending calls to us. */
+
+    CallQueue &queue = GetQueue();
+    UIntPtr count = 0;
+
+    while (GetQueue(count) != Null) count++;
+
+    ASSERT((queue.Requests = new CrossCall[count]()) != Null);
+    AtomicStore(queue.Online, True);
+}
+
+Boolean Call::RunOnCore(CrossCall &Request, UIntPtr Core, Void (*Function)(Void*), Void *Argument) {
+    /* Asynchronous version: returns False if the target doesn't exist (or isn't running yet), or if the request is
+     * still queued (it's only going to run once either way). */
+
+    CallQueue *queue = GetQueue(Core);
+
+    if (Function == Null || queue == Null || !AtomicLoad(queue->Online) || AtomicExchange(Request.Queued, True))
+        return False;
+
+    Request.Function = Function;
+    Request.Context = Argument;
+    Request.Left = Null;
+
+    if (Push(*queue, Request)) Notify(Core);
+
+    return True;
+}
+
+Boolean Call::RunOnCore(UIntPtr Core, Void (*Function)(Void*), Void *Argument) {
+    /* Synchronous version: the function already ran by the time we return (calling ourselves just calls the function
+     * directly). */
+
+    if (Function == Null) return False;
+
+    volatile UIntPtr left = 1;
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+
+    CallQueue &queue = GetQueue(), *target = GetQueue(Core);
+
+    if (Core == Arch::GetCoreId()) Function(Argument);
+    else if (target == Null || queue.Requests == Null || !AtomicLoad(target->Online)) {
+        ARCH_SENSITIVE_END();
+        return False;
+    } else {
+        CrossCall &req = queue.Requests[Core];
+
+        req.Queued = True;
+        req.Function = Function;
+        req.Context = Argument;
+        req.Left = &left;
+
+        if (Push(*target, req)) Notify(Core);
+        Wait(left);
+    }
+
+    ARCH_SENSITIVE_END();
+
+    return True;
+}
+
+Void Call::RunOnAll(Void (*Function)(Void*), Void *Argument, Boolean Self) {
+    /* Synchronous broadcast: queue the request on every other core that is running (the ones that are still booting
+     * have nothing to be called for), run it ourselves (if the caller wants that) while the others are handling their
+     * IPIs, and wait for everyone to be done. */
+
+    if (Function == Null) return;
+
+    volatile UIntPtr left = 0;
+    UIntPtr Context;
+    CallQueue *cur;
+
+    ARCH_SENSITIVE_START();
+
+    CallQueue &queue = GetQueue();
+    UIntPtr id = Arch::GetCoreId();
+
+    for (UIntPtr i = 0; queue.Requests != Null && (cur = GetQueue(i)) != Null; i++) {
+        if (i == id || !AtomicLoad(cur->Online)) continue;
+
+        CrossCall &req = queue.Requests[i];
+
+        req.Queued = True;
+        req.Function = Function;
+        req.Context = Argument;
+        req.Left = &left;
+
+        AtomicAddFetch(left, 1);
+        if (Push(*cur, req)) Notify(i);
+    }
+
+    if (Self) Function(Argument);
+    Wait(left);
+
+    ARCH_SENSITIVE_END();
+}
+
+Void Call::StopOthers(Void) {
+    /* Used when we're panicking: each core gets its own (preallocated) halt request, so this works even with a broken
+     * heap, and we don't wait for anyone (whoever is stuck with interrupts disabled is not going to answer). */
+
+    UIntPtr id = Arch::GetCoreId();
+    CallQueue *cur;
+
+    for (UIntPtr i = 0; (cur = GetQueue(i)) != Null; i++)
+        if (i != id) RunOnCore(cur->Halt, i, HaltHandler);
+}
+
+Void Call::Process(Void) {
+    /* This should be called by the arch-specific IPI handler, with interrupts disabled. Everything that was queued
+     * since the last time gets handled at once (in the order it was queued). The request might get reused as soon as
+     * Queued/Left tell the caller that we're done, so we need to read everything out of it before that. */
+
+    CrossCall *cur = AtomicExchange(GetQueue().Incoming, Null), *rev = Null;
+
+    while (cur != Null) {
+        CrossCall *next = cur->Next;
+        cur->Next = rev;
+        rev = cur;
+        cur = next;
+    }
+
+    while (rev != Null) {
+        CrossCall *next = rev->Next;
+        volatile UIntPtr *left = rev->Left;
+
+        rev->Function(rev->Context);
+        AtomicStore(rev->Queued, False);
+        if (left != Null) AtomicSubFetch(*left, 1);
+
+        rev = next;
+    }
+}
+
+Boolean Call::Push(CallQueue &Queue, CrossCall &Request) {
+    /* We only need to send an IPI if the mailbox was empty: otherwise there is already one on the way (and the target
+     * is going to pick this request up together with the others). */
+
+    CrossCall *head;
+
+    do Request.Next = head = AtomicLoad(Queue.Incoming);
+    while (!AtomicCompareExchange(Queue.Incoming, head, &Request));
+
+    return head == Null;
+}
+
+Void Call::Wait(volatile UIntPtr &Left) {
+    /* We have interrupts disabled, so we need to keep handling whatever is sent to us while we wait (else two cores
+     * calling each other at the same time would deadlock). */
+
+    while (AtomicLoad(Left)) {
+        Process();
+        ARCH_PAUSE();
+    }
+}
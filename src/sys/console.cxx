@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 08 of 2021, at 00:14 BRT
- * Last edited on July 20 of 2021, at 15:40 BRT */
+ * Last edited on October 20 of 2026, at 00:50 BRT */
 
 #include <vid/console.hxx>
 
@@ -40,11 +40,25 @@ Void DebugConsole::DisableGraphics(Void) {
 }
 
 Boolean DebugConsole::WriteInt(Char Data) {
-    /* Handle both overflow on the X axis (move into the next line) and overflow on the Y axis (scroll the screen). */
-
     if (!Data) return Initialized;
-
     Arch::WriteDebug(Data);
+    return DrawCharacter(Data);
+}
+
+Boolean DebugConsole::WriteStringInt(const Char *Data, UIntPtr Length) {
+    /* Whole spans (everything but the arguments of Write/VariadicFormat) come here: the debug port gets all of it at
+     * once, and then we only need to draw the glyphs (no virtual call for each character). */
+
+    Arch::WriteDebug(Data, Length);
+
+    if (Front.GetBuffer() == Null) return True;
+    for (; Length--; Data++) if (*Data && !DrawCharacter(*Data)) return False;
+
+    return True;
+}
+
+Boolean DebugConsole::DrawCharacter(Char Data) {
+    /* Handle both overflow on the X axis (move into the next line) and overflow on the Y axis (scroll the screen). */
 
     if (Front.GetBuffer() == Null) return True;
     else if (X + DefaultFont.GlyphInfo[static_cast<UInt8>(Data)].Advance > Back.GetWidth())
@@ -1,11 +1,16 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 06 of 2021, at 12:22 BRT
- * Last edited on July 21 of 2021, at 20:07 BRT */
+ * Last edited on October 20 of 2026, at 10:00 BRT */
 
 #include <sys/arch.hxx>
+#include <sys/bench.hxx>
+#include <sys/idle.hxx>
 #include <sys/mm.hxx>
 #include <sys/panic.hxx>
+#include <sys/rcu.hxx>
+#include <sys/sched.hxx>
+#include <sys/timer.hxx>
 
 using namespace CHicago;
 
@@ -27,8 +32,13 @@ extern "C" Void SmpEntry(Void) {
     Arch::InitializeCore();
     Debug.Write("{}core {} is alive{}\n", SetForeground { 0xFF00FF00 }, Arch::GetCoreId(), RestoreForeground{});
 
+    /* Our boot context becomes the first thread of this core, but it has nothing else to do, so we can exit right after
+     * telling the BSP that we're alive (and let the idle thread/whatever we steal from the other cores run). */
+
+    Rcu::Initialize();
+    Scheduler::Initialize();
     Arch::FinishCore();
-    Arch::Halt(False);
+    Scheduler::Exit();
 }
 
 extern "C" Void KernelEntry(const BootInfo &Info) {
@@ -73,6 +83,15 @@ extern "C" Void KernelEntry(const BootInfo &Info) {
     Acpi::Initialize(Info);
     Acpi::InitializeArch(Info);
 
+    /* Now that we have timers (and all the other cores are up), we can start the scheduler on the BSP as well. */
+
+    Rcu::Initialize();
+    Scheduler::Initialize();
+
+#ifdef BENCHMARK
+    Benchmark::Run();
+#endif
+
     /* By now we should have the timer setup, so we can take over the debug console (on the graphics frontend), and
      * start displaying other things to the screen. */
 
@@ -90,5 +109,5 @@ extern "C" Void KernelEntry(const BootInfo &Info) {
         CopySection(back, front, x + w2, y, w1 - w2, h);
     }
 
-    Arch::Halt(False);
+    Idle::Loop();
 }
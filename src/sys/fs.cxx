@@ -1,7 +1,7 @@
 /* File author is Ítalo Lima Marconato Matias
  *
  * Created on February 28 of 2021, at 14:02 BRT
- * Last edited on July 06 of 2021, at 20:02 BRT */
+ * Last edited on October 20 of 2026, at 11:30 BRT */
 
 #include <sys/fs.hxx>
 
@@ -10,7 +10,9 @@ using namespace CHicago;
 const FsImpl FileSys::EmptyFs {};
 const MountPoint FileSys::EmptyMp;
 List<FsImpl> FileSys::FileSystems;
-List<MountPoint> FileSys::MountPoints;
+HashMap<StringView, UIntPtr> FileSys::FileSysNames;
+HashSet<MountPoint> *FileSys::MountPoints = Null;
+SpinLock FileSys::MountLock;
 
 File::File() : Name(), Flags(0), Fs(), Priv(Null), References(Null), Length(0), INode(0) { }
 File::File(File &&Source)
@@ -20,7 +22,7 @@ File::File(File &&Source)
 
 File::File(const File &Source)
         : Name(Source.Name), Flags(Source.Flags), Fs(Source.Fs), Priv(Source.Priv), References(Source.References),
-          Length(Source.Length), INode(Source.INode) { if (References != Null) (*References)++; }
+          Length(Source.Length), INode(Source.INode) { if (References != Null) AtomicAddFetch(*References, 1); }
 
 File::File(const String &Name, UInt8 Flags, const FsImpl &Fs, UInt64 Length, const Void *Priv, UInt64 INode)
     : Name(Name), Flags(Flags), Fs(Fs), Priv(Priv), References(new UIntPtr), Length(Length), INode(INode) {
@@ -34,7 +36,7 @@ File::~File() {
 Void File::Close() {
     /* Remove a bit of redundancy. */
 
-    if (References == Null || !--(*References)) {
+    if (References == Null || !AtomicSubFetch(*References, 1)) {
         if (References != Null) delete References;
         if (Fs.Close != Null) Fs.Close(Priv, INode);
     }
@@ -78,7 +80,7 @@ File &File::operator =(const File &Source) {
         INode = Source.INode;
         References = Source.References;
 
-        if (References != Null) (*References)++;
+        if (References != Null) AtomicAddFetch(*References, 1);
     }
 
     return *this;
@@ -156,70 +158,71 @@ MountPoint &MountPoint::operator =(const MountPoint &Source) {
     return *this;
 }
 
-List<String> FileSys::TokenizePath(const StringView &Path) {
-    /* The String class already have a function that tokenizes the string, and return a List<> of tokens, but we have
-     * some tokens that we need to remove... */
+StringView FileSys::CanonicalizePath(const StringView &Path, const StringView &Increment, Char *Buffer, UIntPtr Size) {
+    /* Same as below, but the result goes into a buffer that the caller gave us (usually on the stack). Each component
+     * gets appended (with a slash before it) as we go, and '..' just cuts the buffer back to the last slash. If the
+     * buffer is too small, we return an empty view (with a Null value). */
 
-    List<String> ret = Path.Tokenize("/");
+    const StringView *srcs[2] = { &Path, &Increment };
+    UIntPtr len = 0;
 
-    for (UIntPtr i = 0; i < ret.GetLength();) {
-        if (ret[i].Compare(".")) {
-            /* '.' means the current directory, we can just remove the token without doing anything else. */
-            ret.Remove(i);
-        } else if (ret[i].Compare("..")) {
-            /* '..' means the parent directory, we need to remove ourselves and the token before us (or,
-             * in case there is no entry before us, only remove ourselves. */
+    if (Buffer == Null || Size < 2) return {};
 
-            if (i > 0) ret.Remove(--i);
-            ret.Remove(i);
-        } else i++;
+    for (const StringView *src : srcs) {
+        for (StringView part : src->Split("/")) {
+            if (part.Compare(".")) continue;
+            else if (part.Compare("..")) {
+                while (len && Buffer[--len] != '/') ;
+                continue;
+            } else if (len + part.GetViewLength() + 2 > Size) return {};
+
+            Buffer[len++] = '/';
+            CopyMemory(&Buffer[len], part.begin(), part.GetViewLength());
+            len += part.GetViewLength();
+        }
     }
 
-    return ret;
+    if (!len) Buffer[len++] = '/';
+    Buffer[len] = 0;
+
+    return { Buffer, 0, len };
 }
 
 String FileSys::CanonicalizePath(const StringView &Path, const StringView &Increment) {
-    /* This time, we need to tokenize TWO strings, append the contents of the second list to the first, and do the same
-     * process we did in the TokenizePath function. */
-
-    List<String> lpath = Path.Tokenize("/"), lincr = Increment.Tokenize("/");
+    /* Try with a buffer on the stack first (which should be big enough for almost every path), and only allocate one
+     * if it wasn't big enough (the result is never bigger than both strings plus two slashes). */
 
-    if (lincr.GetLength() && lpath.Add(lincr) != Status::Success) return {};
+    Char buf[256];
+    StringView res = CanonicalizePath(Path, Increment, buf, sizeof(buf));
 
-    /* Now, we can do the same process to remove the '.' and the '..'s. */
+    if (res.GetValue() != Null) return res;
 
-    for (UIntPtr i = 0; i < lpath.GetLength();) {
-        if (lpath[i].Compare(".")) {
-            /* '.' means the current directory, we can just remove the token without doing anything else. */
-            lpath.Remove(i);
-        } else if (lpath[i].Compare("..")) {
-            /* '..' means the parent directory, we need to remove ourselves and the token before us (or,
-             * in case there is no entry before us, only remove ourselves. */
+    UIntPtr size = Path.GetViewLength() + Increment.GetViewLength() + 3;
+    Char *big = new Char[size];
 
-            if (i > 0) lpath.Remove(--i);
-            lpath.Remove(i);
-        } else i++;
-    }
+    if (big == Null) return {};
 
-    /* Finally, let's try to alloc the return string, let's just hope that the allocations are not going to fail here,
-     * at the very end. */
-
-    if (!lpath.GetLength()) return "/";
-
-    String ret;
-    for (const String &part : lpath) ret.Append("/{}", part);
+    String ret = CanonicalizePath(Path, Increment, big, size);
+    delete[] big;
 
     return ret;
 }
 
 Status FileSys::Register(const FsImpl &Info) {
     /* Almost all of the Impl fields can be Null, except for the Name field, as we use it to make sure there
-     * is no duplicate filesystem registered. */
+     * is no duplicate filesystem registered. The list keeps the registration order (Mount probes the filesystems in
+     * that order, so the first registered driver that accepts a device gets it), and the name table just maps each
+     * name into its index on the list. */
+
+    Status status;
 
     if (Info.Name == Null) return Status::InvalidArg;
-    else if (&GetFileSys(Info.Name) != &EmptyFs) return Status::AlreadyExists;
+    else if (FileSysNames.Contains(StringView(Info.Name))) return Status::AlreadyExists;
+    else if ((status = FileSystems.Add(Info)) != Status::Success) return status;
+    else if ((status = FileSysNames.Add(Info.Name, FileSystems.GetLength() - 1)) != Status::Success)
+        FileSystems.Remove(FileSystems.GetLength() - 1);
 
-    return FileSystems.Add(Info);
+    return status;
 }
 
 static StringView FixView(const StringView &Path) {
@@ -234,29 +237,40 @@ Status FileSys::CheckMountPoint(const StringView &Path) {
      * a Boolean isn't enough. */
 
     if (Path[0] != '/') return Status::InvalidArg;
-    else if (!MountPoints.GetLength()) return Status::NotMounted;
-
-    StringView path = FixView(Path);
 
-    for (const MountPoint &mp : MountPoints) {
-        if (!(mp.GetPath().Compare(path))) continue;
-        return Status::AlreadyMounted;
-    }
+    UIntPtr ctx = Rcu::ReadLock();
+    Boolean res = HasMountPoint(AtomicLoad(MountPoints, __ATOMIC_ACQUIRE), FixView(Path));
+    Rcu::ReadUnlock(ctx);
 
-    return Status::NotMounted;
+    return res ? Status::AlreadyMounted : Status::NotMounted;
 }
 
 Status FileSys::CreateMountPoint(const StringView &Path, const File &Root) {
     /* We need to export this to be visible so the user can mount the boot directory, the root directory, the
-     * /Devices folder etc. */
+     * /Devices folder etc. The mount point table is RCU-protected, so we never modify it in place: we make a copy with
+     * the new entry, publish it, and only free the old one after everyone that could be looking at it is done. */
 
     if (Path[0] != '/' || (Root.GetFlags() & (OPEN_READ | OPEN_DIR)) != (OPEN_READ | OPEN_DIR))
         return Status::InvalidArg;
 
+    Status status;
     StringView path = FixView(Path);
 
-    return MountPoints.GetLength() && CheckMountPoint(path) != Status::NotMounted ? Status::AlreadyMounted :
-           MountPoints.Add(MountPoint(path, Root));
+    MountLock.Acquire();
+
+    HashSet<MountPoint> *old = MountPoints,
+                        *list = old != Null ? new HashSet<MountPoint>(*old) : new HashSet<MountPoint>();
+
+    if (HasMountPoint(old, path)) status = Status::AlreadyMounted;
+    else if (list == Null || (old != Null && list->GetLength() != old->GetLength())) status = Status::OutOfMemory;
+    else if ((status = list->Add(MountPoint(path, Root))) == Status::Success) AtomicStore(MountPoints, list);
+
+    MountLock.Release();
+
+    if (status != Status::Success) delete list;
+    else Rcu::Delete(old);
+
+    return status;
 }
 
 static Status CheckFlags(UInt8 SourceFlags, UInt8 Flags) {
@@ -273,53 +287,71 @@ static Status CheckFlags(UInt8 SourceFlags, UInt8 Flags) {
 
 Status FileSys::Open(const StringView &Path, UInt8 Flags, File &Out) {
     if (Path[0] != '/') return Status::InvalidArg;
-    else if (MountPoints.GetLength() == 0) return Status::DoesntExist;
+    else if (AtomicLoad(MountPoints) == Null) return Status::DoesntExist;
     else if ((Flags & OPEN_RECUR_CREATE) && !(Flags & OPEN_CREATE)) Flags |= OPEN_CREATE;
 
     /* The 'Flags' variable aren't on the format that the File class expects. It contains info about if we should create
      * the file in case it doesn't exists, if we can create all the folders in a recur way etc. We can extract the valid
      * File flags by using a mask (which zeroes out all the invalid flags). We need to get the mount point of the path,
      * the GetMountPoint function returns both the mount point and the remainder of the path (that is, the original
-     * path, but with the mount point path removed), we can tokenize the remainder, and try to open/create
-     * everything. */
+     * path, but with the mount point path removed), we can canonicalize the remainder, and try to open/create each
+     * component. We only need to be inside a RCU read-side section while we look up the mount point and copy the
+     * root (after that, we have our own reference to it), so lookups on multiple cores never wait on each other. */
 
+    File dir;
     Status status;
-    String remain;
+    StringView remain;
     UInt8 ffile = Flags & FILE_FLAGS_MASK, fdir = ffile | OPEN_DIR;
+    UIntPtr ctx = Rcu::ReadLock();
     const MountPoint &mp = GetMountPoint(Path, remain);
+    Boolean found = &mp != &EmptyMp;
+
+    if (found) dir = mp.GetRoot();
+
+    Rcu::ReadUnlock(ctx);
 
     if (Flags & OPEN_CREATE) fdir |= OPEN_WRITE;
-    if (&mp == &EmptyMp) return Status::NotMounted;
-    else if ((status = CheckFlags(mp.GetRoot().GetFlags(), !remain.GetLength() ? ffile : fdir)) != Status::Success) {
+    if (!found) return Status::NotMounted;
+    else if ((status = CheckFlags(dir.GetFlags(), !remain.GetViewLength() ? ffile : fdir)) != Status::Success) {
         return status;
-    } else if (!remain.GetLength()) return Out = mp.GetRoot(), Status::Success;
+    } else if (!remain.GetViewLength()) return Out = Move(dir), Status::Success;
 
-    List<String> parts = TokenizePath(remain);
-    if (!parts.GetLength()) return Status::OutOfMemory;
+    /* The components are just views into the canonicalized path (which lives on the stack unless the path is really
+     * long), so walking the path doesn't allocate anything. If everything was '.'/'..', we're opening the root. */
 
-    File dir = mp.GetRoot();
+    Char buf[256];
+    String big;
+    StringView path = CanonicalizePath(remain, "", buf, sizeof(buf));
 
-    while (parts.GetLength() != 1) {
-        File cur;
-        String name = Move(parts[0]);
+    if (path.GetValue() == Null) {
+        if (!(big = CanonicalizePath(remain)).GetLength()) return Status::OutOfMemory;
+        path = big;
+    }
+
+    StringSplit parts = path.Split("/");
+    auto it = parts.begin(), end = parts.end();
 
-        parts.Remove(0);
+    if (it == end) {
+        if ((status = CheckFlags(dir.GetFlags(), ffile)) != Status::Success) return status;
+        return Out = Move(dir), Status::Success;
+    }
+
+    StringView name = *it;
+
+    for (; ++it != end; name = *it) {
+        File cur;
 
         if ((status = dir.Search(name, fdir, cur)) != Status::Success)
             if (status != Status::DoesntExist || !(Flags & OPEN_RECUR_CREATE) ||
-                (status = dir.Create(name, fdir)) != Status::Success) return status;
+                (status = dir.Create(name, fdir)) != Status::Success ||
+                (status = dir.Search(name, fdir, cur)) != Status::Success) return status;
 
         dir = Move(cur);
     }
 
-    /* Now only the creation of the file/directory itself is left, we can remove the last list entry, delete the
-     * list, and try to search for the file. If we do find it, we need to make sure that the user didn't said that we
-     * should only try to create the file, and if we don't find it and the create flag is set, we need to try creating
-     * it. */
-
-    String name = Move(parts[0]);
-
-    parts.Remove(0);
+    /* Now only the creation of the file/directory itself is left (name is the last component), and we can try to
+     * search for the file. If we do find it, we need to make sure that the user didn't said that we should only try to
+     * create the file, and if we don't find it and the create flag is set, we need to try creating it. */
 
     if ((status = dir.Search(name, ffile, Out)) != Status::Success) {
         if (status != Status::DoesntExist || !(Flags & OPEN_CREATE) ||
@@ -365,63 +397,84 @@ Status FileSys::Mount(const StringView &Dest, const StringView &Source, UInt8 Fl
 Status FileSys::Unmount(const StringView &Path) {
     /* Unmounting is just a matter of finding the mount point struct that points to Path (Path has to be the EXACT
      * mount path, not some sub-folder or file inside the mount point). We need to do the same handling of trailing
-     * slashes on the Path as we do on the CreateMountPoint function. */
+     * slashes on the Path as we do on the CreateMountPoint function. Just like in CreateMountPoint, we publish a copy
+     * of the table without the entry, but this time we wait for the grace period ourselves (instead of deferring the
+     * free), as we want the old table (and its reference to the root) gone before calling the FS driver. */
 
     if (Path[0] != '/') return Status::InvalidArg;
-    else if (!MountPoints.GetLength()) return Status::NotMounted;
 
-    UIntPtr idx = 0;
     StringView path = FixView(Path);
+    const MountPoint *ent;
+    MountPoint mp;
 
-    for (const MountPoint &mp : MountPoints) {
-        if (!(mp.GetPath().Compare(path))) {
-            idx++;
-            continue;
-        }
+    MountLock.Acquire();
 
-        mp.GetRoot().Unmount();
-        MountPoints.Remove(idx);
+    HashSet<MountPoint> *old = MountPoints, *list;
 
-        return Status::Success;
+    if (old == Null || (ent = old->Find(path)) == Null) {
+        MountLock.Release();
+        return Status::NotMounted;
+    } else if ((list = new HashSet<MountPoint>(*old)) == Null || list->GetLength() != old->GetLength()) {
+        MountLock.Release();
+        delete list;
+        return Status::OutOfMemory;
     }
 
-    return Status::NotMounted;
+    mp = *ent;
+    list->Remove(path);
+    AtomicStore(MountPoints, list);
+
+    MountLock.Release();
+
+    Rcu::Synchronize();
+    delete old;
+    mp.GetRoot().Unmount();
+
+    return Status::Success;
 }
 
 const FsImpl &FileSys::GetFileSys(const StringView &Path) {
-    /* As the StringView class contains a constructor around C-strings, they will be auto converted into CHicago strings
-     * which makes our job a lot easier. */
+    /* The name table gives us the index of the filesystem, so this is a single lookup (no need to compare against
+     * every registered filesystem). */
 
-    if (FileSystems.GetLength()) for (const FsImpl &fs : FileSystems) if (Path.Compare(fs.Name)) return fs;
-    return EmptyFs;
+    const UIntPtr *idx = FileSysNames.Find(Path);
+    return idx != Null ? FileSystems[*idx] : EmptyFs;
 }
 
-const MountPoint &FileSys::GetMountPoint(const StringView &Path, String &Remain) {
-    /* We have two options to iterate through the list and try to get the right mount point: checking each mount point
-     * that the path is equal to the start of our Path, and return the one with the bigger length, or, copying the
-     * string, and doing something like what we do at CreateMountPoint, but remembering to save the length, and only do
-     * the 'stop at next slash' after each iteration. We're going with the second option. */
+const MountPoint &FileSys::GetMountPoint(const StringView &Path, StringView &Remain) {
+    /* The mount point that we want is the one with the longest path that is a prefix of our Path, but only prefixes
+     * that end at a component boundary count (else, a mount at /Dev would match /Devices). So we start with the whole
+     * path (without the trailing slashes), and keep cutting it at the previous slash (down to the root), doing one
+     * lookup on the mount point table for each step (that is, one per path component, instead of one comparison per
+     * mount point per character). */
 
-    if (!MountPoints.GetLength()) return EmptyMp;
+    /* The caller should be inside a RCU read-side section (and the returned mount point is only valid until it
+     * leaves it). */
 
-    UIntPtr len = 0, start = Path.GetViewLength(), end = start;
+    HashSet<MountPoint> *list = AtomicLoad(MountPoints, __ATOMIC_ACQUIRE);
+    if (list == Null || !list->GetLength()) return EmptyMp;
+
+    UIntPtr end = Path.GetViewLength();
     for (; end > 1 && Path[end - 1] == '/'; end--) ;
 
-    for (StringView path { Path.GetValue() + Path.GetViewStart(), 0, end-- }; path.GetViewLength();
-                                                                              path.SetView(0, end--), start--, len++) {
-        for (const MountPoint &mp : MountPoints) {
-            if (mp.GetPath().Compare(path)) {
-                for (UIntPtr i = 0; i < len; i++) {
-                    if (Remain.Append(Path[start + i]) != Status::Success) {
-                        Remain.Clear();
-                        return EmptyMp;
-                    }
-                }
-
-                return mp;
-            }
-        }
+    for (UIntPtr len = end; len;) {
+        const MountPoint *mp = list->Find(StringView { Path.GetValue() + Path.GetViewStart(), 0, len });
+
+        if (mp != Null) {
+            Remain = Path;
+            Remain.SetView(Path.GetViewStart() + len, Path.GetViewStart() + end);
+            return *mp;
+        } else if (len == 1) break;
+
+        for (len--; len > 1 && Path[len] != '/'; len--) ;
     }
 
     return EmptyMp;
 }
+
+Boolean FileSys::HasMountPoint(const HashSet<MountPoint> *Points, const StringView &Path) {
+    /* Same as CheckMountPoint, but on a snapshot of the table that the caller already has (and Path shouldn't have any
+     * trailing slashes). */
+
+    return Points != Null && Points->Contains(Path);
+}
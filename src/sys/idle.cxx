@@ -0,0 +1,47 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 12:10 BRT
+ * Last edited on October 19 of 2026, at 15:10 BRT */
+
+#include <sys/idle.hxx>
+#include <sys/rcu.hxx>
+#include <util/lock.hxx>
+
+using namespace CHicago;
+
+Void Idle::WaitFor(const volatile Boolean &Flag) {
+    /* The flag should be set by some interrupt handler (or by another core), and we need to check it with interrupts
+     * disabled, else the interrupt could come in between the check and the halt (and we would sleep until whatever
+     * comes next). */
+
+    while (True) {
+        UIntPtr Context;
+
+        ARCH_SENSITIVE_START();
+
+        if (AtomicLoad(Flag)) {
+            ARCH_SENSITIVE_END();
+            return;
+        }
+
+        Rcu::EnterIdle();
+        Arch::WaitForInterrupt(&Flag);
+        Rcu::Quiescent();
+        ARCH_SENSITIVE_END();
+    }
+}
+
+no_return Void Idle::Loop(Void) {
+    /* Parked cores just go to sleep over and over again (the timer/IPI handlers run as the interrupts come in). While
+     * sleeping, we can't be inside any RCU read-side section, so nobody has to wait for us. */
+
+    while (True) {
+        UIntPtr Context;
+
+        ARCH_SENSITIVE_START();
+        Rcu::EnterIdle();
+        Arch::WaitForInterrupt();
+        Rcu::Quiescent();
+        ARCH_SENSITIVE_END();
+    }
+}
@@ -0,0 +1,177 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 15:10 BRT
+ * Last edited on October 19 of 2026, at 16:55 BRT */
+
+#include <sys/rcu.hxx>
+
+using namespace CHicago;
+
+volatile UInt64 Rcu::Started = 0, Rcu::Completed = 0, Rcu::Requested = 0;
+
+Void Rcu::Initialize(Void) {
+    /* This should be called once on each core, before it starts touching anything RCU-protected (until now, this core
+     * was treated as idle, so nobody is waiting for it). */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+    Quiescent();
+    ARCH_SENSITIVE_END();
+}
+
+Void Rcu::Call(Void (*Function)(Void*), Void *Context) {
+    /* Compatibility version of Call (just like Timer::SetEvent), where we manage the callback struct ourselves. If we
+     * can't allocate it, waiting for the grace period right here is the only thing left to do (so this should not be
+     * called from an interrupt handler/read-side section). */
+
+    if (Function == Null) return;
+
+    auto callback = new RcuCallback();
+
+    if (callback == Null) {
+        Synchronize();
+        Function(Context);
+        return;
+    }
+
+    callback->Allocated = True;
+    Call(*callback, Function, Context);
+}
+
+Void Rcu::Call(RcuCallback &Callback, Void (*Function)(Void*), Void *Context) {
+    /* The callback can only run after a grace period that started after this point (anyone that could still see the
+     * old data is going to be done by then). The poll timer of this core runs for as long as it has any callback
+     * pending. */
+
+    if (Function == Null) return;
+
+    RcuData &data = GetData();
+
+    Callback.Next = Null;
+    Callback.Function = Function;
+    Callback.Context = Context;
+
+    data.Lock.Acquire();
+
+    Callback.Target = Request();
+
+    if (data.Tail != Null) data.Tail->Next = &Callback;
+    else {
+        data.Head = &Callback;
+        Timer::SetEvent(data.Poll, TimeUnit::Milliseconds, RCU_POLL_INTERVAL, PollHandler, &data);
+    }
+
+    data.Tail = &Callback;
+    data.Lock.Release();
+}
+
+Void Rcu::Synchronize(Void) {
+    /* Blocking version of Call: wait until everything that was published before this point can be safely freed. With
+     * only one core there is nothing to wait for (we're not inside a read-side section, and nobody else could be).
+     * We report our own quiescent states here, as the caller might have interrupts disabled (and in that case, the
+     * only other way for us to report them would be the idle loop). */
+
+    if (GetData(1) == Null) return;
+
+    UInt64 target = Request();
+
+    while (True) {
+        UIntPtr Context;
+
+        ARCH_SENSITIVE_START();
+        Quiescent();
+        ARCH_SENSITIVE_END();
+
+        Advance();
+        if (AtomicLoad(Completed) >= target) return;
+
+        Timer::Sleep(TimeUnit::Milliseconds, RCU_POLL_INTERVAL);
+    }
+}
+
+Void Rcu::Quiescent(Void) {
+    /* This should be called with interrupts disabled (else we might end up reporting for another core), at some point
+     * where this core is not inside any read-side section (the arch-specific code calls us on every interrupt). Only
+     * coming out of the idle state needs a full fence (as we're about to start reading stuff again); the normal case is
+     * just a plain store (though said store needs to be ordered after everything the core read before). */
+
+    RcuData &data = GetData();
+
+    if (AtomicLoad(data.Idle, __ATOMIC_RELAXED)) {
+        AtomicStore(data.Idle, False, __ATOMIC_RELAXED);
+        AtomicFence();
+    }
+
+    AtomicStore(data.Seen, AtomicLoad(Started, __ATOMIC_RELAXED), __ATOMIC_RELEASE);
+}
+
+Void Rcu::EnterIdle(Void) {
+    /* Idle cores can't be inside any read-side section, so there is no need to wait for them (the next Quiescent call,
+     * be it in the interrupt that woke us up or in the idle loop itself, takes us out of this state). */
+
+    AtomicStore(GetData().Idle, True, __ATOMIC_RELEASE);
+}
+
+UInt64 Rcu::Request(Void) {
+    /* Whatever grace period is running right now (if any) might have started before our caller unpublished the old
+     * data, so we need the one after it. */
+
+    UInt64 res = AtomicLoad(Started) + 1, cur = AtomicLoad(Requested);
+    while (cur < res && !AtomicCompareExchange(Requested, cur, res)) cur = AtomicLoad(Requested);
+    return res;
+}
+
+Void Rcu::Advance(Void) {
+    /* Any core can try to push the grace periods forward: the current one ends when every (non-idle) core reported a
+     * quiescent state after it started, and a new one only starts if someone is waiting for it. Completed needs to be
+     * read before Started (else we could see a newer Completed than Started, and move it back). If two cores race
+     * here, the CAS makes sure that only one of them actually does anything. */
+
+    UInt64 completed = AtomicLoad(Completed), started = AtomicLoad(Started);
+    RcuData *cur;
+
+    if (completed != started) {
+        for (UIntPtr i = 0; (cur = GetData(i)) != Null; i++)
+            if (!AtomicLoad(cur->Idle) && AtomicLoad(cur->Seen) < started) return;
+        AtomicCompareExchange(Completed, completed, started);
+    }
+
+    if (AtomicLoad(Requested) > started) AtomicCompareExchange(Started, started, started + 1);
+}
+
+Void Rcu::PollHandler(Void *Context) {
+    /* Runs from the timer deferred work (so we are also in a quiescent state right now, the interrupted code couldn't
+     * have been inside a read-side section, and we're not inside one either). Collect everything whose grace
+     * period already ended (and re-arm the poll timer if anything is left) while holding the lock, but only call the
+     * callbacks after releasing it (they're free to queue new callbacks). */
+
+    auto data = static_cast<RcuData*>(Context);
+    RcuCallback *head, *last = Null;
+
+    Quiescent();
+    Advance();
+
+    UInt64 completed = AtomicLoad(Completed);
+
+    data->Lock.Acquire();
+
+    for (RcuCallback *cur = head = data->Head; cur != Null && cur->Target <= completed; cur = cur->Next) last = cur;
+
+    if (last == Null) head = Null;
+    else if (data->Head = last->Next, last->Next = Null, data->Head == Null) data->Tail = Null;
+
+    if (data->Head != Null) Timer::SetEvent(data->Poll, TimeUnit::Milliseconds, RCU_POLL_INTERVAL, PollHandler, data);
+
+    data->Lock.Release();
+
+    while (head != Null) {
+        RcuCallback *next = head->Next;
+        Boolean alloc = head->Allocated;
+
+        head->Function(head->Context);
+        if (alloc) delete head;
+
+        head = next;
+    }
+}
@@ -0,0 +1,362 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 12:40 BRT
+ * Last edited on October 20 of 2026, at 00:20 BRT */
+
+#include <sys/idle.hxx>
+#include <sys/panic.hxx>
+#include <sys/sched.hxx>
+
+using namespace CHicago;
+
+UIntPtr Scheduler::NextId = 0;
+
+static Void IdleEntry(Void*) {
+    Idle::Loop();
+}
+
+Void Scheduler::Initialize(Void) {
+    /* This should be called once on each core (after the timer is up): whatever is running right now becomes the
+     * first thread of this core, and we also create the idle thread (which is only going to run when this core has
+     * nothing else to do, and when nothing can be stolen from the other cores). */
+
+    UIntPtr Context;
+    RunQueue &queue = GetQueue();
+    auto stack = new UInt8[SCHED_STACK_SIZE];
+    auto boot = new Thread { Null, AtomicFetchAdd(NextId, 1), Arch::GetCoreId(), Null, Null, CreateFpuState(),
+                             ThreadState::Running, Null, Null, True };
+    auto idle = new Thread { Null, AtomicFetchAdd(NextId, 1), Arch::GetCoreId(), stack, Null, CreateFpuState(),
+                             ThreadState::Ready, IdleEntry, Null, False };
+
+    ASSERT(stack != Null && boot != Null && idle != Null && boot->FpuState != Null && idle->FpuState != Null);
+
+    InitializeArch(*boot);
+    idle->Frame = CreateFrame(*idle);
+
+    ARCH_SENSITIVE_START();
+    queue.Id = Arch::GetCoreId();
+    queue.Idle = idle;
+    AtomicStore(queue.Current, boot);
+    Timer::SetEvent(queue.Quantum, TimeUnit::Milliseconds, SCHED_QUANTUM, QuantumHandler, &queue);
+    ARCH_SENSITIVE_END();
+}
+
+Thread *Scheduler::CreateThread(Void (*Entry)(Void*), Void *Argument) {
+    /* New threads go into the queue of the core that created them (the idle cores are going to steal them if this
+     * core is too busy). */
+
+    if (Entry == Null) return Null;
+
+    auto thread = new Thread();
+    if (thread == Null) return Null;
+    else if ((thread->Stack = new UInt8[SCHED_STACK_SIZE]) == Null) {
+        delete thread;
+        return Null;
+    } else if ((thread->FpuState = CreateFpuState()) == Null) {
+        delete[] thread->Stack;
+        delete thread;
+        return Null;
+    }
+
+    thread->Id = AtomicFetchAdd(NextId, 1);
+    thread->Entry = Entry;
+    thread->Argument = Argument;
+    thread->Frame = CreateFrame(*thread);
+
+    RunQueue &queue = GetQueue();
+
+    queue.Lock.Acquire();
+    thread->Core = queue.Id;
+    Enqueue(queue, *thread);
+    queue.Lock.Release();
+
+    WakeIdle(queue);
+
+    return thread;
+}
+
+Void Scheduler::Yield(Void) {
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+    AtomicStore(GetQueue().Resched, True);
+    Trigger();
+    ARCH_SENSITIVE_END();
+}
+
+Void Scheduler::Block(const volatile Boolean *Flag) {
+    /* The thread stays out of any queue until someone calls Unblock on it. Interrupts are disabled until we switch
+     * away, so the only way for the wakeup to come before that is from another core (and Unblock handles that). The
+     * flag (if any) is checked again after we're marked as blocked, while still holding the lock that Unblock takes:
+     * if it got set between the caller checking it and now, Unblock already saw us as not blocked (and did nothing),
+     * so we need to back out instead of sleeping forever. */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+
+    RunQueue &queue = GetQueue();
+
+    queue.Lock.Acquire();
+    queue.Current->State = ThreadState::Blocked;
+
+    if (Flag != Null && AtomicLoad(*Flag)) {
+        queue.Current->State = ThreadState::Running;
+        queue.Lock.Release();
+        ARCH_SENSITIVE_END();
+        return;
+    }
+
+    queue.Lock.Release();
+
+    AtomicStore(queue.Resched, True);
+    Trigger();
+    ARCH_SENSITIVE_END();
+}
+
+Void Scheduler::Unblock(Thread &Target) {
+    /* If the thread didn't manage to switch away yet, just mark it as running again (it'll go back to the queue on
+     * the switch), else put it back in the queue of the last core that ran it (waking said core up if needed). The
+     * core of the thread is only changed under the lock of the queue that it's moving into, so we have to check it
+     * again after taking the lock (and retry if it moved). The state needs to be read before the core: the core is set
+     * before the thread gets to run (and so before it can block), so if we see it blocked, we also see the right core
+     * (a blocked thread never moves). */
+
+    RunQueue *queue;
+
+    while (True) {
+        if ((queue = GetQueue(AtomicLoad(Target.Core))) == Null) return;
+
+        queue->Lock.Acquire();
+
+        if (Target.State != ThreadState::Blocked) {
+            queue->Lock.Release();
+            return;
+        } else if (AtomicLoad(Target.Core) == queue->Id) break;
+
+        queue->Lock.Release();
+    }
+
+    if (queue->Current == &Target) Target.State = ThreadState::Running;
+    else Enqueue(*queue, Target);
+
+    queue->Lock.Release();
+
+    if (queue != &GetQueue() && AtomicLoad(queue->Current) == queue->Idle) Wake(queue->Id);
+}
+
+Void Scheduler::WaitFor(const volatile Boolean &Flag) {
+    /* Same as Idle::WaitFor, but only this thread sleeps (not the whole core); whoever sets the flag should also call
+     * Unblock on us. */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+    while (!AtomicLoad(Flag)) Block(&Flag);
+    ARCH_SENSITIVE_END();
+}
+
+no_return Void Scheduler::Exit(Void) {
+    /* We can't free our own stack (we're still running on it), so just mark ourselves as dead, and let the next
+     * Schedule call on this core free everything. */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+
+    RunQueue &queue = GetQueue();
+
+    queue.Lock.Acquire();
+    queue.Current->State = ThreadState::Dead;
+    queue.Lock.Release();
+
+    AtomicStore(queue.Resched, True);
+    Trigger();
+
+    /* We should never get here. */
+
+    Arch::Halt(True);
+}
+
+Void *Scheduler::Schedule(Void *Frame) {
+    /* This should be called by the arch-specific code before returning from any interrupt (with interrupts still
+     * disabled), and it returns the context that we should return to. We only switch if the quantum of the current
+     * thread ended, or someone asked us to (Yield/Block/Exit); the idle thread always tries to find something else to
+     * run. */
+
+    RunQueue &queue = GetQueue();
+    Thread *cur = queue.Current, *next;
+
+    if (cur == Null || (!AtomicExchange(queue.Resched, False) && cur != queue.Idle)) return Frame;
+
+    for (Thread *dead = queue.Dead; dead != Null; dead = next) {
+        next = dead->Next;
+        FreeFpuState(dead->FpuState);
+        delete[] dead->Stack;
+        delete dead;
+    }
+
+    queue.Dead = Null;
+    queue.Lock.Acquire();
+
+    cur->Frame = Frame;
+
+    if (cur->State == ThreadState::Dead) {
+        cur->Next = queue.Dead;
+        queue.Dead = cur;
+    } else if (cur->State == ThreadState::Running && cur != queue.Idle) Enqueue(queue, *cur);
+
+    next = Dequeue(queue, cur);
+
+    queue.Lock.Release();
+
+    if (next == Null && (next = Steal(queue)) == Null) next = queue.Idle;
+
+    /* Everything that Unblock looks at (our current thread, and the state/core of the new one) only changes while we
+     * hold the lock. As cur was still the current thread while we were looking for something to run, it might have
+     * been unblocked in the meantime (which only marked it as running), in which case it either keeps running (if
+     * the alternative was the idle thread) or goes back into the queue. The thread that we're switching away from
+     * stays marked as on this core until FinishSwitch (the arch code calls it after leaving its stack), so no other
+     * core can steal it and start running on the same stack. */
+
+    queue.Lock.Acquire();
+
+    if (next != cur && cur->State == ThreadState::Running && cur != queue.Idle) {
+        if (next == queue.Idle) next = cur;
+        else Enqueue(queue, *cur);
+    }
+
+    if (next != cur) queue.Previous = cur;
+
+    next->State = ThreadState::Running;
+    next->OnCpu = True;
+    AtomicStore(next->Core, queue.Id);
+    AtomicStore(queue.Current, next);
+
+    Boolean more = queue.Length;
+
+    queue.Lock.Release();
+
+    if (next != cur) Switch(*cur, *next);
+
+    /* If we left anything behind, some other (idle) core might be able to run it. The quantum timer only runs while
+     * we have an actual thread running (idle cores should not be woken up for nothing). */
+
+    if (more) WakeIdle(queue);
+
+    Timer::CancelEvent(queue.Quantum);
+    if (next != queue.Idle) Timer::SetEvent(queue.Quantum, TimeUnit::Milliseconds, SCHED_QUANTUM, QuantumHandler,
+                                            &queue);
+
+    return next->Frame;
+}
+
+Void Scheduler::FinishSwitch(Void) {
+    /* Called by the arch-specific code right after it moved into the stack of the new thread (interrupts are still
+     * disabled): only now the thread that we switched away from is really off this core, so other cores can take it. */
+
+    RunQueue &queue = GetQueue();
+    Thread *prev = queue.Previous;
+
+    if (prev == Null) return;
+
+    queue.Previous = Null;
+    AtomicStore(prev->OnCpu, False);
+}
+
+Thread *Scheduler::GetCurrentThread(Void) {
+    /* Returns Null if the scheduler isn't running on this core yet (or if this is the idle thread). */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+    RunQueue &queue = GetQueue();
+    Thread *res = queue.Current == queue.Idle ? Null : queue.Current;
+    ARCH_SENSITIVE_END();
+
+    return res;
+}
+
+no_return Void Scheduler::Start(Void) {
+    /* New threads start here (the arch-specific code sets the initial context to jump into us), with interrupts
+     * enabled. */
+
+    UIntPtr Context;
+
+    ARCH_SENSITIVE_START();
+    Thread *thread = GetQueue().Current;
+    ARCH_SENSITIVE_END();
+
+    thread->Entry(thread->Argument);
+    Exit();
+}
+
+Void Scheduler::Enqueue(RunQueue &Queue, Thread &Target) {
+    Target.Next = Null;
+    Target.State = ThreadState::Ready;
+
+    if (Queue.Tail != Null) Queue.Tail->Next = &Target;
+    else Queue.Head = &Target;
+
+    Queue.Tail = &Target;
+    Queue.Length++;
+}
+
+Thread *Scheduler::Dequeue(RunQueue &Queue, const Thread *Self) {
+    /* Threads that some core is still running on (or still switching away from) are skipped, except for Self (the
+     * thread that this core is switching away from, which can just keep running). */
+
+    Thread *prev = Null, *res = Queue.Head;
+
+    for (; res != Null && res->OnCpu && res != Self; prev = res, res = res->Next) ;
+
+    if (res == Null) return Null;
+    else if (prev != Null) prev->Next = res->Next;
+    else Queue.Head = res->Next;
+
+    if (Queue.Tail == res) Queue.Tail = prev;
+
+    Queue.Length--;
+
+    return res;
+}
+
+Thread *Scheduler::Steal(RunQueue &Queue) {
+    /* We have nothing to run, so take the oldest thread from the first core that has anything waiting (we only peek
+     * at the length without the lock, so that we don't bounce the lock of busy cores for nothing). Threads whose core
+     * didn't finish switching away from them yet can't be taken. */
+
+    RunQueue *other;
+
+    for (UIntPtr i = 0; (other = GetQueue(i)) != Null; i++) {
+        if (other == &Queue || !AtomicLoad(other->Length)) continue;
+
+        other->Lock.Acquire();
+        Thread *res = Dequeue(*other);
+        other->Lock.Release();
+
+        if (res != Null) return res;
+    }
+
+    return Null;
+}
+
+Void Scheduler::WakeIdle(RunQueue &Queue) {
+    RunQueue *other;
+
+    for (UIntPtr i = 0; (other = GetQueue(i)) != Null; i++) {
+        if (other == &Queue || other->Idle == Null || AtomicLoad(other->Current) != other->Idle) continue;
+        Wake(other->Id);
+        return;
+    }
+}
+
+Void Scheduler::QuantumHandler(Void *Context) {
+    /* If we don't have per-core timers, the event might have expired on another core, so we need to warn the right
+     * core. */
+
+    auto queue = static_cast<RunQueue*>(Context);
+
+    AtomicStore(queue->Resched, True);
+    if (queue != &GetQueue()) Wake(queue->Id);
+}
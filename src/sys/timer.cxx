@@ -0,0 +1,362 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 10:05 BRT
+ * Last edited on October 20 of 2026, at 10:30 BRT */
+
+#include <sys/idle.hxx>
+#include <sys/panic.hxx>
+#include <sys/sched.hxx>
+
+using namespace CHicago;
+
+ClockSource Timer::Source { "none", Null, 0, 0, 0, 0 };
+SeqLock Timer::SourceLock;
+
+static UInt64 GetNanoseconds(TimeUnit Unit, UInt64 Count) {
+    UInt64 mul = Unit == TimeUnit::Nanoseconds ? 1 : (Unit == TimeUnit::Microseconds ? 1000 :
+                 (Unit == TimeUnit::Milliseconds ? 1000000 : 1000000000));
+    return Count > TIMER_WHEEL_NONE / mul ? TIMER_WHEEL_NONE : Count * mul;
+}
+
+struct SleepContext {
+    volatile Boolean Done;
+    Thread *Waiter;
+};
+
+static Void SleepHandler(Void *Context) {
+    auto ctx = static_cast<SleepContext*>(Context);
+    Thread *waiter = ctx->Waiter;
+
+    AtomicStore(ctx->Done, True);
+    if (waiter != Null) Scheduler::Unblock(*waiter);
+}
+
+Void TimerWheel::Insert(TimerEvent &Event) {
+    /* Level 0 has the events that are going to expire in the next 64 units, level 1 the ones in the next 64^2 units,
+     * and so on; the slot is just the relevant bits of the (absolute) deadline. */
+
+    UInt64 delta = Event.Deadline - Current;
+    UInt8 level = delta < TIMER_WHEEL_LEVEL_SIZE ? 0 : (63 - __builtin_clzll(delta)) / TIMER_WHEEL_LEVEL_SHIFT,
+          slot = (Event.Deadline >> (level * TIMER_WHEEL_LEVEL_SHIFT)) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+
+    Event.Level = level;
+    Event.Slot = slot;
+    Event.Prev = Null;
+
+    if ((Event.Next = Slots[level][slot]) != Null) Event.Next->Prev = &Event;
+
+    Slots[level][slot] = &Event;
+    Occupied[level] |= 1ull << slot;
+}
+
+Boolean TimerWheel::Add(TimerEvent &Event) {
+    /* The caller should be holding the lock (and the deadline should already be in wheel units). Deadlines that
+     * already passed go into the very next slot, and deadlines too far into the future get clamped (so that they fit
+     * into the last level). */
+
+    if (Event.Wheel != Null) return False;
+    else if (Event.Deadline <= Current) Event.Deadline = Current + 1;
+    else if (Event.Deadline - Current > TIMER_WHEEL_MAX_DELTA) Event.Deadline = Current + TIMER_WHEEL_MAX_DELTA;
+
+    Event.Wheel = this;
+    Insert(Event);
+
+    return True;
+}
+
+Boolean TimerWheel::Remove(TimerEvent &Event) {
+    /* Events that already expired (but whose handler didn't run yet) are on the expired list (with an invalid level),
+     * and can still be removed from there. */
+
+    if (Event.Wheel != this) return False;
+
+    if (Event.Prev != Null) Event.Prev->Next = Event.Next;
+    else if (Event.Level == TIMER_WHEEL_LEVELS) Expired = Event.Next;
+    else if ((Slots[Event.Level][Event.Slot] = Event.Next) == Null) Occupied[Event.Level] &= ~(1ull << Event.Slot);
+    if (Event.Next != Null) Event.Next->Prev = Event.Prev;
+
+    Event.Wheel = Null;
+
+    return True;
+}
+
+Boolean TimerWheel::Advance(UInt64 Now) {
+    /* For each level, we need to go through all the slots that we went past since the last time we were called (on
+     * level N, each slot is 64^N units long, so we can stop as soon as a level didn't move). Everything inside those
+     * slots either already expired (and goes into the expired list, still owned by this wheel until the handler gets
+     * called), or is close enough to be moved to a lower level. */
+
+    TimerEvent *pending = Null;
+    Boolean res = False;
+
+    if (Now <= Current) return False;
+
+    for (UIntPtr level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        UIntPtr shift = level * TIMER_WHEEL_LEVEL_SHIFT;
+        UInt64 from = Current >> shift, to = Now >> shift, mask = TIMER_WHEEL_NONE;
+
+        if (from == to) break;
+        else if (to - from < TIMER_WHEEL_LEVEL_SIZE) {
+            UIntPtr start = (from + 1) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+            mask = (1ull << (to - from)) - 1;
+            mask = (mask << start) | (start ? mask >> (64 - start) : 0);
+        }
+
+        for (UInt64 bits = Occupied[level] & mask; bits; bits &= bits - 1) {
+            UIntPtr slot = __builtin_ctzll(bits);
+            TimerEvent *cur = Slots[level][slot];
+
+            Slots[level][slot] = Null;
+            Occupied[level] &= ~(1ull << slot);
+
+            while (cur != Null) {
+                TimerEvent *next = cur->Next;
+
+                if (cur->Deadline <= Now) {
+                    cur->Level = TIMER_WHEEL_LEVELS;
+                    cur->Prev = Null;
+                    if ((cur->Next = Expired) != Null) Expired->Prev = cur;
+                    Expired = cur;
+                    res = True;
+                } else {
+                    cur->Next = pending;
+                    pending = cur;
+                }
+
+                cur = next;
+            }
+        }
+    }
+
+    Current = Now;
+
+    while (pending != Null) {
+        TimerEvent *next = pending->Next;
+        Insert(*pending);
+        pending = next;
+    }
+
+    return res;
+}
+
+Void TimerWheel::RunExpired(Void *Context) {
+    /* Deferred work queued by Timer::Process: take the expired events out one at a time (so that they can still be
+     * cancelled up until the moment we get to them), and call the handlers without holding the lock (they are free to
+     * add new events, including the same one that just expired). */
+
+    auto wheel = static_cast<TimerWheel*>(Context);
+
+    while (True) {
+        wheel->Lock.Acquire();
+
+        TimerEvent *cur = wheel->Expired;
+
+        if (cur == Null) {
+            wheel->Lock.Release();
+            return;
+        }
+
+        wheel->Remove(*cur);
+        wheel->Lock.Release();
+
+        Boolean alloc = cur->Allocated;
+
+        cur->Handler(cur->Context);
+        if (alloc) delete cur;
+    }
+}
+
+UInt64 TimerWheel::GetNextDeadline(Void) const {
+    /* On level 0 the first occupied slot after the current one gives us the exact deadline, on the other levels it
+     * gives us when the slot is going to be cascaded down (which is good enough, as that's the point where we need to
+     * be called again). */
+
+    UInt64 res = TIMER_WHEEL_NONE;
+
+    for (UIntPtr level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        if (!Occupied[level]) continue;
+
+        UIntPtr shift = level * TIMER_WHEEL_LEVEL_SHIFT;
+        UInt64 cur = Current >> shift, bits = Occupied[level], rot = (cur + 1) & (TIMER_WHEEL_LEVEL_SIZE - 1);
+
+        if (rot) bits = (bits >> rot) | (bits << (64 - rot));
+        if ((cur = (cur + 1 + __builtin_ctzll(bits)) << shift) < res) res = cur;
+    }
+
+    return res;
+}
+
+Boolean Timer::SetEvent(TimeUnit Unit, UInt64 Count, Void (*Handler)(Void*)) {
+    /* Compatibility version of SetEvent, where we manage the event ourselves (the event is freed right after the
+     * handler is called, and there is no way to cancel it). */
+
+    auto event = new TimerEvent();
+
+    if (event == Null) return False;
+    else if (event->Allocated = True, !SetEvent(*event, Unit, Count, Handler)) {
+        delete event;
+        return False;
+    }
+
+    return True;
+}
+
+Boolean Timer::SetEvent(TimerEvent &Event, TimeUnit Unit, UInt64 Count, Void (*Handler)(Void*), Void *Context) {
+    /* Convert the deadline into wheel units (rounding up, we should never fire earlier than what the caller asked
+     * for), add it to the wheel of this core, and re-arm the hardware if this is now the first event to expire. */
+
+    if (Handler == Null) return False;
+
+    TimerWheel &wheel = GetWheel();
+    UInt64 now = GetUpTime(TimeUnit::Nanoseconds), delay = GetNanoseconds(Unit, Count),
+           deadline = delay > TIMER_WHEEL_NONE - now - (1 << TIMER_WHEEL_SHIFT) ? TIMER_WHEEL_NONE >> TIMER_WHEEL_SHIFT :
+                      (now + delay + (1 << TIMER_WHEEL_SHIFT) - 1) >> TIMER_WHEEL_SHIFT;
+
+    wheel.Lock.Acquire();
+
+    if (AtomicLoad(Event.Wheel) != Null) {
+        wheel.Lock.Release();
+        return False;
+    }
+
+    Event.Handler = Handler;
+    Event.Context = Context;
+    Event.Deadline = deadline;
+    wheel.Add(Event);
+
+    if (Event.Deadline < wheel.Armed) Arm((wheel.Armed = Event.Deadline) << TIMER_WHEEL_SHIFT);
+
+    wheel.Lock.Release();
+
+    return True;
+}
+
+Boolean Timer::CancelEvent(TimerEvent &Event) {
+    /* The event might be on the wheel of another core, so lock whichever wheel it is in (and retry if it expired and
+     * got re-added somewhere else in the meantime). We don't bother re-arming the hardware of our own wheel, the worst
+     * that can happen is one interrupt where we find nothing to do; but if we just cancelled what another core was
+     * going to wake up for, we ask it to re-arm itself (as it might be idle). Also, if this returns False, the event
+     * already expired (and the handler might be running right now). */
+
+    for (TimerWheel *wheel; (wheel = AtomicLoad(Event.Wheel)) != Null;) {
+        wheel->Lock.Acquire();
+        Boolean res = wheel->Remove(Event), remote = res && Event.Deadline == wheel->Armed && wheel != &GetWheel();
+        wheel->Lock.Release();
+
+        if (remote) Call::RunOnCore(wheel->Reprogram, wheel->Core, Reprogram, wheel);
+        if (res) return True;
+    }
+
+    return False;
+}
+
+Void Timer::Reprogram(Void *Context) {
+    /* Runs on the core that owns the wheel (through a cross-core call from CancelEvent). We can only move the deadline
+     * forward (to whatever is the first event now), and if there is nothing left, we just let the old deadline fire. */
+
+    auto wheel = static_cast<TimerWheel*>(Context);
+
+    wheel->Lock.Acquire();
+
+    UInt64 next = wheel->GetNextDeadline();
+
+    if (wheel == &GetWheel() && next != TIMER_WHEEL_NONE && next > wheel->Armed)
+        Arm((wheel->Armed = next) << TIMER_WHEEL_SHIFT);
+
+    wheel->Lock.Release();
+}
+
+Void Timer::SetClockSource(const Char *Name, UInt64 (*Read)(Void), UInt64 Numerator, UInt64 Denominator) {
+    /* Each tick of the new source takes Numerator/Denominator nanoseconds, and we want that as a 32-bit multiplier
+     * (and a shift), with the highest precision possible. The new source starts counting from whatever uptime the old
+     * one was reporting. */
+
+    if (Read == Null || !Numerator || !Denominator) return;
+
+    UInt32 shift = 32;
+    UInt64 mult = 0;
+
+    for (; shift; shift--) {
+        if ((Numerator << shift) >> shift != Numerator) continue;
+        else if ((mult = (Numerator << shift) / Denominator) <= 0xFFFFFFFF) break;
+    }
+
+    if (!shift) mult = Numerator / Denominator;
+
+    SourceLock.AcquireWrite();
+    UInt64 now = GetUpTime(Source, TimeUnit::Nanoseconds);
+    Source = { Name, Read, Read(), now, static_cast<UInt32>(mult), shift };
+    SourceLock.ReleaseWrite();
+
+    Debug.Write("{}using {} as the clock source ({}/2^{} ns per tick){}\n", SetForeground { 0xFF00FF00 }, Name,
+                mult, shift, RestoreForeground{});
+}
+
+Void Timer::Sleep(TimeUnit Unit, UInt64 Count) {
+    /* If something can wake us up, put a timer event on the stack and sleep until it expires (blocking only this
+     * thread if the scheduler is running, else the whole core); otherwise (early boot, or the caller has interrupts
+     * disabled), we have no other choice but to spin. */
+
+    if (Arch::CanIdle()) {
+        SleepContext ctx { False, Scheduler::GetCurrentThread() };
+        TimerEvent event {};
+
+        if (SetEvent(event, Unit, Count, SleepHandler, &ctx)) {
+            if (ctx.Waiter != Null) Scheduler::WaitFor(ctx.Done);
+            else Idle::WaitFor(ctx.Done);
+            return;
+        }
+    }
+
+    UInt64 dest = GetUpTime(TimeUnit::Nanoseconds), delay = GetNanoseconds(Unit, Count);
+    for (dest = delay > TIMER_WHEEL_NONE - dest ? TIMER_WHEEL_NONE : dest + delay;
+         GetUpTime(TimeUnit::Nanoseconds) < dest;) ARCH_PAUSE();
+}
+
+ClockSource Timer::GetClockSource(Void) {
+    ClockSource res;
+    UIntPtr seq;
+
+    do {
+        seq = SourceLock.ReadBegin();
+        res = Source;
+    } while (SourceLock.ReadRetry(seq));
+
+    return res;
+}
+
+UInt64 Timer::GetUpTime(TimeUnit Unit) {
+    return GetUpTime(GetClockSource(), Unit);
+}
+
+UInt64 Timer::GetUpTime(const ClockSource &Source, TimeUnit Unit) {
+    /* (Delta * Mult) >> Shift, but done in two halves, as the full product doesn't fit into 64-bits (and we don't
+     * have 128-bit multiplication on every arch). The source should be a snapshot (or the caller should be holding
+     * the SourceLock). */
+
+    if (Source.Read == Null) return 0;
+
+    UInt64 delta = Source.Read() - Source.Base, lo = (delta & 0xFFFFFFFF) * Source.Mult,
+           hi = (delta >> 32) * Source.Mult, ns = Source.Offset + (hi << (32 - Source.Shift)) + (lo >> Source.Shift);
+
+    return Unit == TimeUnit::Nanoseconds ? ns : ns / (Unit == TimeUnit::Microseconds ? 1000 :
+                                                      (Unit == TimeUnit::Milliseconds ? 1000000 : 1000000000));
+}
+
+Void Timer::Process(Void) {
+    /* This should be called by the arch-specific timer interrupt handler. We only collect everything that expired (and
+     * re-arm the hardware for the next deadline) here, the handlers are called later, from deferred work (after the EOI,
+     * with interrupts enabled). */
+
+    TimerWheel &wheel = GetWheel();
+
+    wheel.Lock.Acquire();
+
+    Boolean expired = wheel.Advance(GetUpTime(TimeUnit::Nanoseconds) >> TIMER_WHEEL_SHIFT);
+
+    if ((wheel.Armed = wheel.GetNextDeadline()) != TIMER_WHEEL_NONE) Arm(wheel.Armed << TIMER_WHEEL_SHIFT);
+
+    wheel.Lock.Release();
+
+    if (expired) Work::Queue(wheel.Work);
+}
@@ -0,0 +1,71 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 19 of 2026, at 16:55 BRT
+ * Last edited on October 19 of 2026, at 16:55 BRT */
+
+#include <sys/work.hxx>
+
+using namespace CHicago;
+
+Boolean Work::Queue(DeferredWork &Item) {
+    /* Returns False if the item was already queued (it's only going to run once either way). Interrupts need to be
+     * disabled, else we might end up queueing it on some other core (if we get rescheduled in the middle). */
+
+    if (Item.Function == Null || AtomicExchange(Item.Queued, True)) return False;
+
+    UIntPtr Context;
+    DeferredWork *head;
+
+    ARCH_SENSITIVE_START();
+
+    WorkQueue &queue = GetQueue();
+
+    do Item.Next = head = AtomicLoad(queue.Incoming);
+    while (!AtomicCompareExchange(queue.Incoming, head, &Item));
+
+    ARCH_SENSITIVE_END();
+
+    return True;
+}
+
+Void Work::Run(Void) {
+    /* This should be called by the arch-specific interrupt handler, after the EOI, with interrupts enabled (and only
+     * on the outermost interrupt, nested interrupts just queue their work, and we pick it up here). Items are marked
+     * as not queued right before running, so that they can queue themselves again. */
+
+    WorkQueue &queue = GetQueue();
+
+    if (queue.Running) return;
+
+    queue.Running = True;
+
+    for (UIntPtr budget = WORK_BUDGET; budget; budget--) {
+        DeferredWork *cur = AtomicExchange(queue.Incoming, Null), *rev = Null;
+
+        while (cur != Null) {
+            DeferredWork *next = cur->Next;
+            cur->Next = rev;
+            rev = cur;
+            cur = next;
+        }
+
+        if (rev != Null) {
+            if (queue.Tail != Null) queue.Tail->Next = rev;
+            else queue.Head = rev;
+            for (queue.Tail = rev; queue.Tail->Next != Null; queue.Tail = queue.Tail->Next) ;
+        }
+
+        if ((cur = queue.Head) == Null) break;
+        else if ((queue.Head = cur->Next) == Null) queue.Tail = Null;
+
+        Void (*func)(Void*) = cur->Function;
+        Void *ctx = cur->Context;
+
+        AtomicStore(cur->Queued, False);
+        func(ctx);
+    }
+
+    queue.Running = False;
+
+    if (queue.Head != Null || AtomicLoad(queue.Incoming) != Null) Trigger();
+}
@@ -0,0 +1,97 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 10:50 BRT
+ * Last edited on October 20 of 2026, at 10:50 BRT */
+
+#include "host.hxx"
+
+using namespace CHicago;
+
+/* Throughput (in GB/s) of the public memory functions for each implementation that this processor can run, for all the
+ * power of two sizes from 1 byte up to 16 MiB. Each measurement is the best of a few runs, and each run repeats the
+ * operation on the same buffers until we moved around BENCH_BYTES (so, anything up to the LLC size is measuring the
+ * warm cache case). MoveMemory always moves the region 8 bytes forward (like inserting something at the front of a
+ * list of pointers), so it only overlaps from 16 bytes up. */
+
+#define BENCH_MAX_SIZE (16 << 20)
+#define BENCH_BYTES (64 << 20)
+#define BENCH_RUNS 4
+#define BENCH_SIZES 25
+#define BENCH_OPERATIONS 4
+#define BENCH_LEVELS 8
+
+static UInt8 BenchSource[BENCH_MAX_SIZE] aligned(64), BenchDest[BENCH_MAX_SIZE + 64] aligned(64);
+static const Char *BenchNames[BENCH_LEVELS], *BenchOperations[] = { "CopyMemory", "SetMemory", "MoveMemory",
+                                                                   "CompareMemory" };
+static Float BenchResults[BENCH_OPERATIONS][BENCH_SIZES][BENCH_LEVELS];
+static UIntPtr BenchLevels = 0;
+static volatile Boolean BenchSink;
+
+template<class T> static Float Measure(UIntPtr Length, T Function) {
+    UIntPtr count = BENCH_BYTES / Length;
+    UInt64 best = 0xFFFFFFFFFFFFFFFF;
+
+    if (count > (1 << 20)) count = 1 << 20;
+    else if (count < 4) count = 4;
+
+    Function();
+
+    for (UIntPtr i = 0; i < BENCH_RUNS; i++) {
+        UInt64 start = HostGetTime();
+        for (UIntPtr j = 0; j < count; j++) Function();
+        UInt64 time = HostGetTime() - start;
+        if (time < best) best = time;
+    }
+
+    return static_cast<Float>(Length) * count / (best ? best : 1);
+}
+
+static Void RunLevel(const Char *Name) {
+    UIntPtr level = BenchLevels++;
+
+    BenchNames[level] = Name;
+
+    for (UIntPtr i = 0; i < BENCH_SIZES; i++) {
+        UIntPtr len = 1ul << i;
+
+        BenchResults[0][i][level] = Measure(len, [len] { CopyMemory(BenchDest, BenchSource, len); });
+        BenchResults[1][i][level] = Measure(len, [len] { SetMemory(BenchDest, 0x5A, len); });
+        BenchResults[2][i][level] = Measure(len, [len] { MoveMemory(&BenchDest[8], BenchDest, len); });
+
+        CopyMemory(BenchDest, BenchSource, len);
+        BenchResults[3][i][level] = Measure(len, [len] { BenchSink = CompareMemory(BenchDest, BenchSource, len); });
+    }
+}
+
+static Void PrintSize(UIntPtr Size) {
+    if (Size >= 1 << 20) printf("%4lu MiB", Size >> 20);
+    else if (Size >= 1 << 10) printf("%4lu KiB", Size >> 10);
+    else printf("%4lu B  ", Size);
+}
+
+int main() {
+    for (UIntPtr i = 0; i < BENCH_MAX_SIZE; i++) BenchSource[i] = static_cast<UInt8>(i * 31 + (i >> 8));
+
+    Memory::Initialize();
+    printf("Memory::Initialize picked %s%s, non-temporal threshold: ", Memory::Functions.Name,
+           Memory::Functions.Erms ? " (with rep movsb/stosb)" : "");
+    if (Memory::NonTemporalThreshold == UINTPTR_MAX) printf("none\n");
+    else printf("%lu KiB\n", Memory::NonTemporalThreshold >> 10);
+
+    HostForEachLevel(RunLevel);
+
+    for (UIntPtr i = 0; i < BENCH_OPERATIONS; i++) {
+        printf("\n%-10s", BenchOperations[i]);
+        for (UIntPtr j = 0; j < BenchLevels; j++) printf(" %13s", BenchNames[j]);
+        printf("\n");
+
+        for (UIntPtr j = 0; j < BENCH_SIZES; j++) {
+            PrintSize(1ul << j);
+            printf("  ");
+            for (UIntPtr k = 0; k < BenchLevels; k++) printf(" %13.2f", BenchResults[i][j][k]);
+            printf("\n");
+        }
+    }
+
+    return 0;
+}
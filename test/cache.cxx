@@ -0,0 +1,163 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 11:10 BRT
+ * Last edited on October 20 of 2026, at 11:10 BRT */
+
+#include "host.hxx"
+
+using namespace CHicago;
+
+/* Cache pollution of big copies/sets, with and without the non-temporal stores. We keep a working set of 1/4 of the LLC
+ * warm, do one SetMemory/CopyMemory of some multiple of the LLC size, and then time how long it takes to read the
+ * working set again (compared to reading it with nothing in between). With normal stores, anything close to the LLC
+ * size evicts most of the working set; with non-temporal stores, only the source of the copies goes through the
+ * caches. That (and the throughput of each mode) is what the default threshold (3/4 of the LLC) is based on.
+ *
+ * Some VMs report the LLC of the whole host (and the cache that we actually get is way smaller), so the LLC size (in
+ * KiB) can also be given as the first argument. */
+
+#define CACHE_RUNS 3
+
+extern "C" void *malloc(unsigned long);
+
+static UInt8 *CacheSource, *CacheDest, *CacheWorking;
+static UIntPtr CacheWorkingSize, CacheFirst;
+static volatile UInt64 CacheSink;
+
+static Void LinkWorkingSet(Void) {
+    /* Each cache line of the working set has the offset of the next one to be read. The pages are read in order (so
+     * that we don't end up measuring TLB misses), but the lines inside of each page are in a random order (so that the
+     * prefetchers can't hide the cache misses). */
+
+    UIntPtr seed = 0x2545F4914F6CDD1D, prev = 0;
+    UInt8 order[64];
+
+    for (UIntPtr page = 0; page < CacheWorkingSize; page += 4096) {
+        for (UIntPtr i = 0; i < 64; i++) order[i] = i;
+
+        for (UIntPtr i = 63; i; i--) {
+            seed = seed * 6364136223846793005 + 1442695040888963407;
+            UIntPtr j = (seed >> 33) % (i + 1);
+            UInt8 tmp = order[i];
+            order[i] = order[j];
+            order[j] = tmp;
+        }
+
+        for (UIntPtr i = 0; i < 64; i++) {
+            UIntPtr off = page + (order[i] << 6);
+            if (page || i) *reinterpret_cast<UIntPtr*>(&CacheWorking[prev]) = off;
+            else CacheFirst = off;
+            prev = off;
+        }
+    }
+
+    *reinterpret_cast<UIntPtr*>(&CacheWorking[prev]) = CacheFirst;
+}
+
+static UInt64 ReadWorkingSet(Void) {
+    UInt64 start = HostGetTime();
+    UIntPtr cur = CacheFirst;
+
+    for (UIntPtr i = 0; i < CacheWorkingSize >> 6; i++) cur = *reinterpret_cast<const UIntPtr*>(&CacheWorking[cur]);
+
+    CacheSink = cur;
+
+    return HostGetTime() - start;
+}
+
+static Void Measure(Boolean Copy, UIntPtr Length, Boolean NonTemporal, Float &Throughput, Float &Reread) {
+    /* Best of a few runs for both the operation itself and the re-read after it. */
+
+    UInt64 op = 0xFFFFFFFFFFFFFFFF, read = 0xFFFFFFFFFFFFFFFF;
+
+    Memory::NonTemporalThreshold = NonTemporal ? 1 : UINTPTR_MAX;
+
+    for (UIntPtr i = 0; i < CACHE_RUNS; i++) {
+        ReadWorkingSet();
+        ReadWorkingSet();
+
+        UInt64 start = HostGetTime();
+        if (Copy) CopyMemory(CacheDest, CacheSource, Length);
+        else SetMemory(CacheDest, static_cast<UInt8>(i), Length);
+        UInt64 time = HostGetTime() - start, reread = ReadWorkingSet();
+
+        if (time < op) op = time;
+        if (reread < read) read = reread;
+    }
+
+    Throughput = static_cast<Float>(Length) / (op ? op : 1);
+    Reread = static_cast<Float>(read);
+}
+
+int main(int argc, char **argv) {
+    Memory::Initialize();
+
+    UInt32 max, bx, cx, dx;
+    asm volatile("cpuid" : "=a"(max), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(0));
+
+    UIntPtr llc = GetCacheSize(max), threshold = Memory::NonTemporalThreshold;
+
+    if (argc > 1) {
+        llc = 0;
+        for (const Char *cur = argv[1]; *cur >= '0' && *cur <= '9'; cur++) llc = llc * 10 + *cur - '0';
+        llc <<= 10;
+        threshold = llc - (llc >> 2);
+    }
+
+    if (!llc) {
+        printf("couldn't get the LLC size (pass it in KiB as the first argument)\n");
+        return 1;
+    }
+
+    /* Sizes are in eighths of the LLC. */
+
+    const UIntPtr sizes[] = { 1, 2, 4, 6, 8, 12, 16 };
+    UIntPtr total = (llc >> 3) * sizes[sizeof(sizes) / sizeof(*sizes) - 1];
+
+    CacheWorkingSize = (llc >> 2) & ~0xFFF;
+    CacheSource = static_cast<UInt8*>(malloc(total));
+    CacheDest = static_cast<UInt8*>(malloc(total));
+    CacheWorking = static_cast<UInt8*>(malloc(CacheWorkingSize));
+
+    if (CacheSource == Null || CacheDest == Null || CacheWorking == Null) {
+        printf("couldn't allocate the buffers\n");
+        return 1;
+    }
+
+    SetMemory(CacheSource, 0x5A, total);
+    SetMemory(CacheDest, 0xA5, total);
+    LinkWorkingSet();
+
+    UInt64 base = 0xFFFFFFFFFFFFFFFF;
+
+    for (UIntPtr i = 0; i < CACHE_RUNS; i++) {
+        ReadWorkingSet();
+        UInt64 time = ReadWorkingSet();
+        if (time < base) base = time;
+    }
+
+    printf("%s%s, LLC of %lu KiB, working set of %lu KiB (re-read in %lu us when warm), threshold at %lu KiB\n",
+           Memory::Functions.Name, Memory::Functions.Erms ? " (with rep movsb/stosb)" : "", llc >> 10,
+           CacheWorkingSize >> 10, base / 1000, threshold >> 10);
+
+    for (UIntPtr i = 0; i < 2; i++) {
+        printf("\n%-13s %16s %16s %16s %16s\n", i ? "CopyMemory" : "SetMemory", "normal (GB/s)", "NT (GB/s)",
+               "re-read normal", "re-read NT");
+
+        for (UIntPtr size : sizes) {
+            UIntPtr len = (llc >> 3) * size;
+            Float normal, nt, rnormal, rnt;
+
+            Measure(i, len, False, normal, rnormal);
+            Measure(i, len, True, nt, rnt);
+
+            printf("%5.2fx LLC%s %16.2f %16.2f %15.2fx %15.2fx\n", size / 8.0, len >= threshold ? "*" : " ", normal, nt,
+                   rnormal / base, rnt / base);
+        }
+    }
+
+    printf("\n(* is where the default threshold switches to non-temporal stores, re-read is relative to the warm one)"
+           "\n");
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 10:50 BRT
+ * Last edited on October 20 of 2026, at 10:50 BRT */
+
+#pragma once
+
+/* The tests/benchmarks run as normal (hosted) programs, but what they run is the kernel code, built straight from the
+ * kernel sources (they get included here, so that the static functions, like the implementations for each SIMD level,
+ * are reachable, and so are the private fields of the Memory class). The only thing that doesn't work in user mode is
+ * the CR0 read inside of ARCH_FPU_USABLE, so that gets replaced by a flag that we control (clearing it is how we get
+ * the public functions to use the GPR table). */
+
+#include <arch/misc.hxx>
+#include <base/types.hxx>
+
+#undef ARCH_FPU_USABLE
+#define ARCH_FPU_USABLE() HostFpuUsable
+
+static CHicago::Boolean HostFpuUsable = True;
+
+#define private public
+#include "../lib/arch/x86/util/memory.cxx"
+#include "../lib/util/memory.cxx"
+#undef private
+
+/* We can't include any of the host headers (they would clash with our own definitions), so declare the few libc
+ * functions that we need by hand. */
+
+struct HostTime {
+    long Seconds, Nanoseconds;
+};
+
+extern "C" int printf(const char*, ...);
+extern "C" int clock_gettime(int, HostTime*);
+
+namespace CHicago {
+
+static inline UInt64 HostGetTime(Void) {
+    HostTime time;
+    clock_gettime(1, &time);
+    return static_cast<UInt64>(time.Seconds) * 1000000000 + time.Nanoseconds;
+}
+
+struct HostLevel {
+    const Char *Name, *ErmsName;
+    Boolean Supported;
+    MemoryFunctions Functions;
+    Void (*Overlap)(Void*, const Void*, UIntPtr);
+};
+
+template<class T> static Void HostForEachLevel(T Callback) {
+    /* Calls Callback(Name) once for each implementation that this processor can run (each SIMD level, with and without
+     * rep movsb/stosb, and at last the GPR table), with everything set up the same way as Memory::Initialize would
+     * have done it. */
+
+    const HostLevel levels[] = {
+        { "SSE2", "SSE2+ERMS", True,
+          { "SSE2", False, CopySse2, SetSse2, Set32Sse2, MoveDispatch, MismatchSse2, LengthSse2, FindSse2 }, MoveSse2 },
+        { "AVX2", "AVX2+ERMS", __builtin_cpu_supports("avx2") != 0,
+          { "AVX2", False, CopyAvx2, SetAvx2, Set32Avx2, MoveDispatch, MismatchAvx2, LengthAvx2, FindAvx2 }, MoveAvx2 },
+        { "AVX-512", "AVX-512+ERMS", __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"),
+          { "AVX-512", False, CopyAvx512, SetAvx512, Set32Avx512, MoveDispatch, MismatchAvx512, LengthAvx512,
+            FindAvx512 }, MoveAvx512 }
+    };
+
+    UInt32 ax, bx, cx, dx;
+    asm volatile("cpuid" : "=a"(ax), "=b"(bx), "=c"(cx), "=d"(dx) : "a"(7), "c"(0));
+
+    for (auto &level : levels) {
+        if (!level.Supported) continue;
+
+        for (UIntPtr erms = 0; erms < 2 && (!erms || (bx & 0x200)); erms++) {
+            Memory::Functions = level.Functions;
+            MoveOverlap = level.Overlap;
+
+            if (erms) {
+                ErmsThreshold = dx & 0x10 ? 128 : 2048;
+                ErmsCopy = Memory::Functions.Copy;
+                ErmsSet = Memory::Functions.Set;
+                Memory::Functions.Erms = True;
+                Memory::Functions.Copy = CopyErms;
+                Memory::Functions.Set = SetErms;
+            }
+
+            Callback(erms ? level.ErmsName : level.Name);
+        }
+    }
+
+    HostFpuUsable = False;
+    Callback(Memory::Scalar.Name);
+    HostFpuUsable = True;
+}
+
+}
@@ -0,0 +1,196 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 10:50 BRT
+ * Last edited on October 20 of 2026, at 10:50 BRT */
+
+#include "host.hxx"
+
+using namespace CHicago;
+
+/* Checks all of the public memory/string functions against each implementation that this processor can run (a broken
+ * head/tail or overlap case in there would corrupt things in very creative ways inside the kernel). Everything goes
+ * through the public functions (so it's the dispatched paths that get checked), on unaligned offsets, with lengths
+ * covering all the head/tail sizes of the vector loops, and the ERMS range, and every written region is surrounded by
+ * some guard bytes that must stay untouched. The whole thing is redone with a tiny non-temporal threshold, so that the
+ * non-temporal loops get checked as well (even if the cache size would make them unreachable with our buffers). */
+
+#define CHECK_SIZE 16384
+#define CHECK_GUARD 64
+
+static UInt8 CheckLeft[CHECK_SIZE], CheckRight[CHECK_SIZE];
+static const UIntPtr CheckLengths[] = { 511, 512, 513, 1023, 1024, 1025, 2047, 2048, 2049, 3000, 4095, 4096, 4097,
+                                        6000 };
+static const UIntPtr CheckOffsets[] = { 0, 1, 3, 7, 15, 17, 31, 33, 63 };
+
+static inline UInt8 GetPattern(UIntPtr Index, UInt8 Seed) {
+    /* Mixing in the upper bits makes sure that anything copied from the wrong place (even 256 bytes away) shows up. */
+    return static_cast<UInt8>((Index ^ (Index >> 8)) * 31 + Seed);
+}
+
+static inline UIntPtr NextPosition(UIntPtr Position, UIntPtr Length) {
+    /* Where to put the mismatch/match next: every position for the short regions, the edges and the middle for the
+     * others. */
+
+    if (Length <= 64 || Position >= Length - 2) return Position + 1;
+    return Position < Length / 2 ? Length / 2 : Length - 2;
+}
+
+static Void FillPattern(UInt8 *Buffer, UIntPtr Start, UIntPtr End, UInt8 Seed) {
+    for (UIntPtr i = Start; i < End; i++) Buffer[i] = GetPattern(i, Seed);
+}
+
+static Boolean CheckCopy(UIntPtr Dest, UIntPtr Source, UIntPtr Length) {
+    FillPattern(CheckLeft, Dest - CHECK_GUARD, Dest + Length + CHECK_GUARD, 1);
+    FillPattern(CheckRight, Source, Source + Length, 2);
+    CopyMemory(&CheckLeft[Dest], &CheckRight[Source], Length);
+
+    for (UIntPtr i = Dest - CHECK_GUARD; i < Dest + Length + CHECK_GUARD; i++)
+        if (CheckLeft[i] != (i >= Dest && i < Dest + Length ? GetPattern(Source + i - Dest, 2) : GetPattern(i, 1)))
+            return False;
+
+    return True;
+}
+
+static Boolean CheckSet(UIntPtr Dest, UIntPtr Length) {
+    /* SetMemory32 is checked here as well (Length is still in bytes, so only the multiples of 4 go through it), the
+     * expected bytes come from the value itself, so that we don't care about the endianness. */
+
+    const UInt32 value = 0xA1B2C3D4;
+    auto bytes = reinterpret_cast<const UInt8*>(&value);
+
+    for (UIntPtr j = 0; j < 2; j++) {
+        if (j && (Length & 3)) break;
+
+        FillPattern(CheckLeft, Dest - CHECK_GUARD, Dest + Length + CHECK_GUARD, 3);
+
+        if (j) SetMemory32(&CheckLeft[Dest], value, Length >> 2);
+        else SetMemory(&CheckLeft[Dest], 0xA5, Length);
+
+        for (UIntPtr i = Dest - CHECK_GUARD; i < Dest + Length + CHECK_GUARD; i++)
+            if (CheckLeft[i] != (i < Dest || i >= Dest + Length ? GetPattern(i, 3)
+                                                                : (j ? bytes[(i - Dest) & 3] : 0xA5)))
+                return False;
+    }
+
+    return True;
+}
+
+static Boolean CheckMove(UIntPtr Dest, UIntPtr Source, UIntPtr Length) {
+    /* Both regions are on the same buffer (and they may or may not overlap, in any direction). */
+
+    UIntPtr start = (Dest < Source ? Dest : Source) - CHECK_GUARD, end = (Dest > Source ? Dest : Source) + Length +
+                                                                          CHECK_GUARD;
+
+    FillPattern(CheckLeft, start, end, 4);
+    MoveMemory(&CheckLeft[Dest], &CheckLeft[Source], Length);
+
+    for (UIntPtr i = start; i < end; i++)
+        if (CheckLeft[i] != GetPattern(i >= Dest && i < Dest + Length ? Source + i - Dest : i, 4)) return False;
+
+    return True;
+}
+
+static Boolean CheckCompare(UIntPtr Left, UIntPtr Right, UIntPtr Length) {
+    /* Equal regions first (the boolean version says that empty regions are never equal), and then one mismatch at a
+     * time, flipping the top bit of the right side, so that we see both signs. */
+
+    UIntPtr off;
+
+    for (UIntPtr i = 0; i < Length; i++) CheckLeft[Left + i] = CheckRight[Right + i] = GetPattern(i, 5);
+
+    if (CompareMemory(&CheckLeft[Left], &CheckRight[Right], Length) != !!Length ||
+        CompareMemory(&CheckLeft[Left], &CheckRight[Right], Length, off) || off != Length) return False;
+
+    for (UIntPtr i = 0; i < Length; i = NextPosition(i, Length)) {
+        UInt8 old = CheckRight[Right + i];
+
+        CheckRight[Right + i] ^= 0x80;
+
+        Int32 res = CompareMemory(&CheckLeft[Left], &CheckRight[Right], Length, off);
+
+        if (CompareMemory(&CheckLeft[Left], &CheckRight[Right], Length) || off != i ||
+            (old & 0x80 ? res <= 0 : res >= 0)) return False;
+
+        CheckRight[Right + i] = old;
+    }
+
+    return True;
+}
+
+static Boolean CheckString(UIntPtr Offset, UIntPtr Length) {
+    /* The string is never followed by the end of the buffer, and whatever comes after the NUL isn't a NUL (nor
+     * anything on the search sets), so reading too far shows up as a wrong result. Sets of up to 4 characters go
+     * through the vector loop, the bigger ones through the bitmap. */
+
+    static const Char set[] = "XYZ#!";
+    auto str = reinterpret_cast<Char*>(&CheckLeft[Offset]);
+
+    for (UIntPtr i = 0; i < Length + CHECK_GUARD; i++) str[i] = static_cast<Char>('a' + GetPattern(i, 6) % 26);
+
+    if (FindChar(str, set[0], Length) != Length || FindAnyOf(str, Length, set, 3) != Length ||
+        FindAnyOf(str, Length, set, 5) != Length) return False;
+
+    for (UIntPtr i = 0; i < Length; i = NextPosition(i, Length)) {
+        Char old = str[i];
+
+        str[i] = set[4];
+        if (FindAnyOf(str, Length, set, 5) != i || FindAnyOf(str, Length, set, 4) != Length) return False;
+
+        str[i] = set[2];
+        if (FindAnyOf(str, Length, set, 3) != i || FindChar(str, set[2], Length) != i ||
+            FindAnyOf(str, Length, set, 1) != Length) return False;
+
+        str[i] = old;
+    }
+
+    str[Length] = 0;
+
+    return StringLength(str) == Length;
+}
+
+static Boolean CheckLength(UIntPtr Length, Boolean Compare) {
+    /* The compare/string primitives don't care about the non-temporal threshold, so they only need to go once. */
+
+    for (UIntPtr off : CheckOffsets) {
+        UIntPtr base = CHECK_GUARD * 2 + off, other = CHECK_GUARD * 2 + (off * 5 + 3) % CHECK_GUARD;
+
+        if (!CheckCopy(base, other, Length) || !CheckSet(base, Length) ||
+            (Compare && (!CheckCompare(base, other, Length) || !CheckString(base, Length))) ||
+            !CheckMove(base, base + off + Length + 1, Length) ||
+            !CheckMove(base + off + 1, base, Length) || !CheckMove(base, base + off + 1, Length) ||
+            !CheckMove(base + Length / 2, base, Length) || !CheckMove(base, base + Length / 2 + 1, Length))
+            return False;
+    }
+
+    return True;
+}
+
+static Boolean CheckLevel(const Char *Name) {
+    /* The second pass is the one with the tiny non-temporal threshold (and without the compare/string checks). */
+
+    UIntPtr old = Memory::NonTemporalThreshold, fail = UINTPTR_MAX, pass = 0;
+
+    for (; pass < 2 && fail == UINTPTR_MAX; pass++) {
+        for (UIntPtr len = 0; len <= 300 && fail == UINTPTR_MAX; len++) if (!CheckLength(len, !pass)) fail = len;
+        for (UIntPtr len : CheckLengths) if (fail == UINTPTR_MAX && !CheckLength(len, !pass)) fail = len;
+        Memory::NonTemporalThreshold = 256;
+    }
+
+    Memory::NonTemporalThreshold = old;
+
+    if (fail == UINTPTR_MAX) printf("%-14s ok\n", Name);
+    else printf("%-14s FAILED (length %lu%s)\n", Name, fail, pass > 1 ? ", non-temporal" : "");
+
+    return fail == UINTPTR_MAX;
+}
+
+int main() {
+    /* Initialize gives us the real non-temporal threshold (and makes sure that the detection code at least runs). */
+
+    Boolean res = True;
+
+    Memory::Initialize();
+    HostForEachLevel([&res](const Char *Name) { res = CheckLevel(Name) && res; });
+
+    return !res;
+}
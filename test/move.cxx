@@ -0,0 +1,83 @@
+/* File author is Ítalo Lima Marconato Matias
+ *
+ * Created on October 20 of 2026, at 11:00 BRT
+ * Last edited on October 20 of 2026, at 11:00 BRT */
+
+#include "host.hxx"
+
+using namespace CHicago;
+
+/* Exhaustive overlap check for the MoveMemory implementations (each vector width of MoveLoop, and the GPR one): for a
+ * vector width W, every size from 0 to 4W, every signed distance between the destination and the source from -2W to 2W
+ * (so both directions, with and without overlap), and a few alignments of the destination (the loops align the
+ * destination, so that's what moves the head/tail split around). Each result is checked against a byte by byte
+ * reference, including some guard bytes on each side, that must stay untouched. */
+
+#define MOVE_SIZE 1024
+#define MOVE_BASE 256
+
+struct MoveTarget {
+    const Char *Name;
+    UIntPtr Width;
+    Boolean Supported;
+    Void (*Function)(Void*, const Void*, UIntPtr);
+};
+
+static UInt8 MoveBuffer[MOVE_SIZE] aligned(64), MoveExpected[MOVE_SIZE] aligned(64);
+
+static Boolean CheckMove(const MoveTarget &Target, UIntPtr Dest, UIntPtr Source, UIntPtr Length) {
+    for (UIntPtr i = 0; i < MOVE_SIZE; i++) MoveBuffer[i] = MoveExpected[i] = static_cast<UInt8>(i * 7 + (i >> 8));
+    for (UIntPtr i = 0; i < Length; i++) MoveExpected[Dest + i] = MoveBuffer[Source + i];
+
+    Target.Function(&MoveBuffer[Dest], &MoveBuffer[Source], Length);
+
+    for (UIntPtr i = 0; i < MOVE_SIZE; i++) if (MoveBuffer[i] != MoveExpected[i]) return False;
+
+    return True;
+}
+
+static Boolean CheckTarget(const MoveTarget &Target) {
+    const UIntPtr w = Target.Width, aligns[] = { 0, 1, 3, w / 2, w - 1 };
+
+    for (UIntPtr align : aligns) {
+        for (UIntPtr len = 0; len <= w * 4; len++) {
+            for (IntPtr dist = -static_cast<IntPtr>(w * 2); dist <= static_cast<IntPtr>(w * 2); dist++) {
+                UIntPtr dst = MOVE_BASE + align, src = dst - dist;
+
+                if (!CheckMove(Target, dst, src, len)) {
+                    printf("%-12s FAILED (length %lu, distance %ld, alignment %lu)\n", Target.Name, len, dist, align);
+                    return False;
+                }
+            }
+        }
+    }
+
+    printf("%-12s ok\n", Target.Name);
+
+    return True;
+}
+
+int main() {
+    const MoveTarget targets[] = {
+        { "MoveSse2", 16, True, MoveSse2 },
+        { "MoveAvx2", 32, __builtin_cpu_supports("avx2") != 0, MoveAvx2 },
+        { "MoveAvx512", 64, __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"), MoveAvx512 },
+        { "MoveGpr", 16, True, MoveGpr }
+    };
+
+    Boolean res = True;
+
+    for (auto &target : targets) {
+        if (target.Supported) res = CheckTarget(target) && res;
+        else printf("%-12s skipped (not supported by this processor)\n", target.Name);
+    }
+
+    /* And the same thing through MoveMemory itself (so that the dispatch between the copy and the overlap paths gets
+     * checked as well), for each implementation, using the widest vector width that we have. */
+
+    HostForEachLevel([&res](const Char *Name) {
+        res = CheckTarget({ Name, 64, True, MoveMemory }) && res;
+    });
+
+    return !res;
+}